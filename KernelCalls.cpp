@@ -1,163 +1,650 @@
-/*
- * File: KernelCalls.cpp
- * Author: Stephen Sampson and Mason Butler
- * Original Date: October 2nd 2017
- * Revised Date: December 5th 2017
- * Purpose: Includes definitions of functions called by the kernel.
- *          These are called while in an SVC and will not be interrupted.
- */
-
-#include "globals.h"
-#include "KernelCalls.h"
-#include "process.h"
-#include "systick.h"
-#include "uart.h"
-#include "queues.h"
-
-/* Kernel call to terminate 'running' process */
-void KTerminateProcess(void){
-    int delpriority = running->priority;                        // priority of process being terminated
-    uartformat *processprint = &FormatTable[running->pid];      // find appropriate entry in print format table
-    for(int i = 0; i < MAX_MSG_QUEUES; i++)                     // iterate through message queues
-        if(msgqueue[i].owner == running)                        // if a message queue is owned by process being deleted
-            msgqueue[i].clear();                                // clear it and free memory being taken up by messages in queue
-    running = running->next;                                    // set running to next process (points back to itself if only item in queue)
-    procqueue[delpriority].remove(running->prev);               // remove the process that was previously running
-    if (procqueue[delpriority].empty()) {                       // if terminated process's priority queue is empty
-        for (int i = HIGHEST; i >= IDLE; i--) {                 // loop from highest to lowest priority
-            if (!procqueue[i].empty()) {                        // until a non empty queue is found
-                highest_p = i;                                  // set global var highest_p to this priority
-                break;                                          // break from loop
-            }
-        }
-        running = procqueue[highest_p].get_front();             // update running process to process at front of highest_p queue
-    }
-    force_psp = TRUE;                                           // SVCall & SVHandler will now set PSP, restart SysTick, and restore registers
-    UART0_printf(processprint->terminate);                      // print diagnostic info to console indicating process has terminated
-}
-
-/**********************************************************************************************************
- * Mason Butler originally authored the functions below. Testing, changes, and comments by Stephen Sampson
- *********************************************************************************************************/
-
-/* Kernel call to get PID of 'runnign' process */
-unsigned int KGetPID(){
-    return running->pid;
-}
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-/* Kernel call to bind process to specified message queue */
-signed int KBind(unsigned int queue_num){
-    if(queue_num < MAX_MSG_QUEUES){                             // if valid message queue number
-        if(msgqueue[queue_num].owner == NULL){                  // verify queue does not already have an owner
-            msgqueue[queue_num].owner = running;                // assign owner of queue to running process
-            uartformat *processprint = &FormatTable[running->pid];
-            UART0_printf(processprint->bind);                   // print diagnostic information to console
-            return queue_num;                                   // return queue number as success message
-        } else                                                  // queue has an owner
-            return ERROR;                                       // return error
-    } else                                                      // invalid queue number
-        return ERROR;                                           // return error
-}
-
-/* Kernel call to send message to destination queue if bound to a process */
-signed int KSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize) {
-    pcb *pcb_ptr = msgqueue[destQueueID].owner;                 // create pointer to PCB that owns specified message queue
-    if(pcb_ptr != NULL) {                                       // if pointer has a value (queue has an owner)
-        msgcontainer *msg = new msgcontainer();                 // create new message container structure
-        msg->size = msgSize;                                    // set size field of message container
-        msg->msg = (char *)message;                             // set message field of message container
-        msgqueue[destQueueID].enqueue(msg);                     // queue message in specified message queue
-        if (pcb_ptr->blocked == TRUE) {                         // if the process to receive the message is blocked
-            procqueue[BLOCKED].dequeue(pcb_ptr);                // remove PCB from blocked queue
-            procqueue[pcb_ptr->priority].enqueue(pcb_ptr);      // place PCB in proper queue (based on priority)
-            pcb_ptr->blocked = FALSE;                           // update blocked flag in newly unblocked PCB
-        }
-        uartformat *processprint = &FormatTable[running->pid];  // find appropriate entry in print format table
-        UART0_printf(processprint->send.append(msg->msg));      // print diagnostic information to console
-        return SUCCESS;                                         // return success
-    }                                                           // otherwise pointer is NULL (queue had no owner)
-    return ERROR;                                               // return error
-}
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-/* Kernel call to receive message from message queue or block if one not available */
-signed int KReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize){
-    pcb *pcb_ptr = msgqueue[queueID].owner;                     // get owner of specified message queue
-    if(pcb_ptr != NULL) {                                       // if specified message queue has an owner (is bound to process)
-        uartformat *processprint = &FormatTable[running->pid];  // find appropriate entry in print format table
-        msgcontainer *msg = msgqueue[queueID].get_front();      // get message at front of specified message queue
-        if(msg != NULL) {                                       // if there exists a message in the message queue (receive process)
-            message = (void *) msg;                             // set value of message to be made available to process
-            UART0_printf(processprint->receive.append(msg->msg));
-            msgqueue[queueID].remove(msg);                      // remove message from message queue and free memory
-            return SUCCESS;                                     // message successfully transmitted
-        } else {                                                // no message in queue (block process and perform a context switch)
-            save_registers();                                   // save registers (push R4->R11 onto the process stack)
-            running -> sp = get_PSP();                          // update the stack pointer in the PCB of the process being switched out
-            running = pcb_ptr->next;                            // set running to next process (points back to itself if only item in queue)
-            set_PSP(running -> sp);                             // update PSP to that saved in the running PCB
-            procqueue[pcb_ptr->priority].dequeue(pcb_ptr);      // dequeue process to be blocked
-            procqueue[BLOCKED].enqueue(pcb_ptr);                // enqueue dequeued process to blocked queue
-            pcb_ptr->blocked = TRUE;                            // set blocked flag in process's PCB
-            if (procqueue[pcb_ptr->priority].empty()) {         // if priority queue of newly blocked process is now empty
-                for (int i = HIGHEST; i >= IDLE; i--) {         // loop from highest to lowest priority
-                    if (!procqueue[i].empty()) {                // until a non empty queue is found
-                        highest_p = i;                          // set global var highest_p to this priority
-                        break;                                  // break from loop
-                    }
-                }
-                running = procqueue[highest_p].get_front();     // update running process to process at front of highest_p queue
-            }
-            UART0_printf(processprint->blocked);                // print diagnostic information to console
-            return SUCCESS;                                     // message successfully queued
-        }
-    }
-    return ERROR;                                               // specified message queue had no owner (not bound to a process)
-}
+/*
+ * File: KernelCalls.cpp
+ * Author: Stephen Sampson and Mason Butler
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Includes definitions of functions called by the kernel.
+ *          These are called while in an SVC and will not be interrupted.
+ */
+
+#include "globals.h"
+#include "KernelCalls.h"
+#include "process.h"
+#include "systick.h"
+#include "uart.h"
+#include "queues.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "svc.h"
+#include "pools.h"
+#include "trace.h"
+#include "kernel.h"
+
+/* Kernel call to terminate 'running' process */
+void KTerminateProcess(void){
+    trace(TR_TERMINATE, running->pid, 0);                       // record the event
+    for(int i = 0; i < MAX_MSG_QUEUES; i++)                     // iterate through message queues
+        if((running->bound & QUEUE_BIT(i)) && --msgqueue[i].members == 0) {  // last process bound to the queue is being deleted
+            msgqueue[i].clear();                                // clear it and free memory being taken up by messages in queue
+            for(pcb *pcb_ptr; (pcb_ptr = msgqueue[i].senders.get_front()) != NULL; ) {   // senders waiting for space fail
+                msgqueue[i].senders.dequeue(pcb_ptr);
+                *pcb_ptr->wait_rtn = (unsigned long) ERROR;
+                ready_wake(pcb_ptr);
+            }
+            for(pcb *pcb_ptr; (pcb_ptr = msgqueue[i].clients.get_front()) != NULL; ) {   // so do rendezvous clients
+                msgqueue[i].clients.dequeue(pcb_ptr);
+                *pcb_ptr->wait_rtn = (unsigned long) ERROR;
+                ready_wake(pcb_ptr);
+            }
+            for(pcb *pcb_ptr; (pcb_ptr = msgqueue[i].awaiting.get_front()) != NULL; ) {  // and those it will never reply to
+                msgqueue[i].awaiting.dequeue(pcb_ptr);
+                *pcb_ptr->wait_rtn = (unsigned long) ERROR;
+                ready_wake(pcb_ptr);
+            }
+            msgqueue[i].owner = NULL;                           // queue may be bound again (PCB will be reused)
+            msgqueue[i].shared = FALSE;
+            if(msgqueue[i].sender != NULL)
+                msgqueue[i].sender->designated &= ~QUEUE_BIT(i);
+            msgqueue[i].sender = NULL;
+        } else if(msgqueue[i].sender == running)                // nobody is expected to send to it any more
+            msgqueue[i].sender = NULL;
+    ready_dequeue(running);                                     // remove the process that was running from its queue
+    running->terminated = TRUE;                                 // PCB and stack returned to their pools by next_process()
+    TriggerPendSV();                                            // switch to next process on exit from SVC
+    KPRINT(running->pid, FormatTable[running->pid].terminate); // print diagnostic info to console indicating process has terminated
+}
+
+/* Kernel call to put 'running' process to sleep. The process leaves the ready
+ * queues for the timer wheel and the switch happens in PendSV on exit from the call */
+int KSleep(unsigned int sleep_ticks){
+    if(sleep_ticks == 0)                                        // nothing to wait for
+        return SUCCESS;
+    trace(TR_SLEEP, running->pid, sleep_ticks);                 // record the event
+    ready_dequeue(running);                                     // running process is no longer waiting to run
+    running->wait_state = WAIT_SLEEP;
+    timer_insert(running, ticks + sleep_ticks);                 // wake it from SysTickHandler() once due
+    TriggerPendSV();                                            // switch to next process on exit from SVC
+    return SUCCESS;
+}
+
+/* Kernel call to give up the CPU: 'running' goes to the back of its level and
+ * the switch happens in PendSV on exit from the call */
+int KYield(void){
+    ready_rotate(running);                                      // next process of the same priority runs first
+    TriggerPendSV();                                            // switch to next process on exit from SVC
+    return SUCCESS;
+}
+
+/* Kernel call to fill 'stats' for the process with PID stats->pid. The
+ * stack is scanned for its high water mark on every call */
+int KProcStats(procstats *stats){
+    pcb *pcb_ptr = pcb_find(stats->pid);                        // find the process
+    if(pcb_ptr == NULL)                                         // no such process
+        return ERROR;
+    stats->priority = pcb_ptr->priority;
+    stats->run_cycles = pcb_ptr->run_cycles;
+    if(pcb_ptr == running)                                      // include the run in progress
+        stats->run_cycles += (unsigned int)(CYCLES() - pcb_ptr->dispatched);
+    stats->switches = pcb_ptr->switches;
+    stats->stack_size = stack_words(pcb_ptr->stackclass) * sizeof(unsigned long);
+    stats->stack_used = stack_high_water(pcb_ptr);
+    stats->overruns = pcb_ptr->overruns;
+    stats->edf = pcb_ptr->edf_stats;
+    return SUCCESS;
+}
+
+/* Kernel call listing what each process that is not ready waits for. At most
+ * 'max' entries of 'list' are filled; the number of waiting processes is returned */
+int KWaitReport(waitinfo *list, unsigned int max){
+    unsigned int count = 0;
+    for(pcb *pcb_ptr = pcb_next(NULL); pcb_ptr != NULL; pcb_ptr = pcb_next(pcb_ptr)) {
+        if(pcb_ptr->wait_state == WAIT_NONE)                    // ready (or running)
+            continue;
+        if(count < max) {
+            list[count].pid = pcb_ptr->pid;
+            list[count].state = pcb_ptr->wait_state;
+            switch(pcb_ptr->wait_state) {
+            case WAIT_RECEIVE:
+            case WAIT_REQUEST:
+                list[count].queues = pcb_ptr->rcv_set;
+                break;
+            case WAIT_SEND:
+            case WAIT_CALL:
+            case WAIT_REPLY:
+                list[count].queues = QUEUE_BIT(pcb_ptr->snd_queue);
+                break;
+            default:
+                list[count].queues = 0;
+            }
+            list[count].timed = pcb_ptr->sleeping;
+            list[count].wake_tick = pcb_ptr->wake_tick;
+        }
+        count++;
+    }
+    return count;
+}
+
+/* Kernel call to get the capacity, depth and high water mark of a message queue */
+int KQueueStats(unsigned int queue_num, queuestats *stats){
+    if(queue_num >= MAX_MSG_QUEUES)                             // invalid message queue number
+        return ERROR;
+    *stats = msgqueue[queue_num].stats;
+    return SUCCESS;
+}
+
+/* Kernel call ending the current job of a periodic process. The job missed
+ * its deadline if it ends at or after it. The next job is released a period
+ * after the last: 'running' waits on the timer wheel until then, or if that
+ * time has already passed (overrun) is released at once with its new deadline */
+int KWaitNextPeriod(void){
+    if(!running->edf)                                           // only periodic processes have periods
+        return ERROR;
+    running->edf_stats.jobs++;
+    if((int)(ticks - running->abs_deadline) >= 0)               // finished too late
+        running->edf_stats.misses++;
+    ready_dequeue(running);                                     // leaves the heap (re-keyed or waiting)
+    running->release += running->period;
+    running->abs_deadline = running->release + running->rel_deadline;
+    if((int)(running->release - ticks) > 0) {                   // wait for the next release
+        running->job_state = JOB_WAITING;
+        running->wait_state = WAIT_PERIOD;
+        timer_insert(running, running->release);
+    } else {                                                    // next release already due
+        running->job_state = JOB_RELEASED;
+        running->release_stamp = CYCLES();
+        ready_enqueue(running);
+    }
+    TriggerPendSV();                                            // earliest deadline runs on exit from SVC
+    return SUCCESS;
+}
+
+/**********************************************************************************************************
+ * Mason Butler originally authored the functions below. Testing, changes, and comments by Stephen Sampson
+ *********************************************************************************************************/
+
+/* Kernel call to get PID of 'runnign' process */
+unsigned int KGetPID(){
+    return running->pid;
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+/* Kernel call to bind process to specified message queue, as its only receiver
+ * (BIND_EXCLUSIVE) or as one of a pool of receivers (BIND_SHARED). The first
+ * bind sets how many messages the queue holds at once (0: unbounded) */
+signed int KBind(unsigned int queue_num, unsigned int mode, unsigned int capacity){
+    if(queue_num < MAX_MSG_QUEUES){                             // if valid message queue number
+        m_queue *queue = &msgqueue[queue_num];
+        bool unbound = (queue->members == 0);
+        if(mode == BIND_SHARED ? (unbound || queue->shared) && !(running->bound & QUEUE_BIT(queue_num)) : unbound){
+            queue->owner = (mode == BIND_SHARED) ? NULL : running;  // assign owner of queue to running process
+            queue->shared = (mode == BIND_SHARED);
+            if(unbound) {                                       // new binding: fresh capacity and statistics
+                queue->stats = queuestats();
+                queue->stats.capacity = capacity;
+            }
+            queue->members++;
+            running->bound |= QUEUE_BIT(queue_num);
+            trace(TR_BIND, running->pid, queue_num);            // record the event
+            KPRINT(running->pid, FormatTable[running->pid].bind); // print diagnostic information to console
+            return queue_num;                                   // return queue number as success message
+        } else                                                  // queue has an owner (or is shared and this is not a shared bind)
+            return ERROR;                                       // return error
+    } else                                                      // invalid queue number
+        return ERROR;                                           // return error
+}
+
+static void priority_update(pcb *ptr);
+
+/* Kernel call to designate the process expected to send to a queue bound by
+ * 'running'. While a receiver is blocked on the queue the sender runs at
+ * (at least) the receiver's priority, so processes of intermediate
+ * priority cannot hold up the message the receiver is waiting for. The
+ * sender it replaces keeps only the priority it is owed elsewhere */
+signed int KDesignateSender(unsigned int queue_num, unsigned long pid){
+    if(queue_num >= MAX_MSG_QUEUES || !(running->bound & QUEUE_BIT(queue_num)))
+        return ERROR;                                           // not the caller's queue
+    pcb *pcb_ptr = NULL;
+    if(pid != NO_SENDER) {
+        pcb_ptr = pcb_find(pid);
+        if(pcb_ptr == NULL || pcb_ptr == running)               // no such process
+            return ERROR;
+    }
+    pcb *previous = msgqueue[queue_num].sender;
+    msgqueue[queue_num].sender = pcb_ptr;
+    if(previous != NULL && previous != pcb_ptr) {
+        previous->designated &= ~QUEUE_BIT(queue_num);
+        priority_update(previous);
+    }
+    if(pcb_ptr != NULL) {                                       // receivers of a shared queue may already be waiting
+        pcb_ptr->designated |= QUEUE_BIT(queue_num);
+        priority_update(pcb_ptr);
+    }
+    return SUCCESS;
+}
+
+/* Priority a process waiting on another passes on to it: its own, or just
+ * above the EDF class for an EDF process */
+static unsigned long owed_level(const pcb *waiter) {
+    return (waiter->priority == EDF_PRIORITY) ? EDF_PRIORITY + 1 : waiter->priority;
+}
+
+/* Raise a designated sender (or rendezvous server) to the priority of the
+ * process waiting on it, noting the level inherited so dropping an aging boost
+ * keeps it. EDF processes keep their deadline order and are not boosted */
+static void priority_inherit(pcb *sender, const pcb *waiter) {
+    unsigned long level = owed_level(waiter);
+    if(sender == NULL || sender->edf)
+        return;
+    if(level > sender->inherited)
+        sender->inherited = level;
+    if(sender->priority >= level)
+        return;
+    trace(TR_INHERIT, sender->pid, level);                      // record the event
+    ready_reprioritise(sender, level);
+}
+
+/* Highest of 'level' and the priorities passed on by the processes of a wait list */
+static unsigned long waiters_level(p_queue *list, unsigned long level) {
+    pcb *front = list->get_front();
+    for(pcb *pcb_ptr = front; pcb_ptr != NULL; pcb_ptr = (pcb_ptr->next == front) ? NULL : pcb_ptr->next)
+        if(owed_level(pcb_ptr) > level)
+            level = owed_level(pcb_ptr);
+    return level;
+}
+
+/* Recompute the priority a process inherits once a process it worked for
+ * stops waiting, from its own sources only: receivers blocked on the queues
+ * it is the designated sender of, and rendezvous clients calling or awaiting
+ * the reply of the queues it owns. It then runs at the highest of that, its
+ * own priority and the level aging raised it to */
+static void priority_update(pcb *ptr) {
+    if(ptr->edf)                                                // keeps its deadline order
+        return;
+    unsigned long level = 0;
+    unsigned long set = ptr->designated | ptr->bound;
+    for(unsigned int q = 0; set != 0; q++, set >>= 1) {
+        if(!(set & 1))
+            continue;
+        m_queue *queue = &msgqueue[q];
+        if(queue->sender == ptr) {
+            if(queue->shared)                                   // its waiters are all receiving from it
+                level = waiters_level(&queue->waiters, level);
+            else if(queue->owner != NULL && queue->owner->wait_state == WAIT_RECEIVE && (queue->owner->rcv_set & QUEUE_BIT(q))
+                    && owed_level(queue->owner) > level)
+                level = owed_level(queue->owner);
+        }
+        if(queue->owner == ptr) {                               // rendezvous clients calling or awaiting its reply
+            level = waiters_level(&queue->clients, level);
+            level = waiters_level(&queue->awaiting, level);
+        }
+    }
+    ptr->inherited = level;
+    unsigned long own = ptr->aged > ptr->base_priority ? ptr->aged : ptr->base_priority;
+    ready_reprioritise(ptr, level > own ? level : own);
+}
+
+/* Copy n bytes, a word at a time while source and destination are both word aligned */
+static void msg_copy(void *dst, const void *src, unsigned int n) {
+    char *d = (char *)dst;
+    const char *s = (const char *)src;
+    if ((((unsigned long)d | (unsigned long)s) & (sizeof(unsigned long) - 1)) == 0) {
+        unsigned long *dw = (unsigned long *)d;
+        const unsigned long *sw = (const unsigned long *)s;
+        for (; n >= sizeof(unsigned long); n -= sizeof(unsigned long))
+            *dw++ = *sw++;
+        d = (char *)dw;
+        s = (const char *)sw;
+    }
+    while (n-- > 0)
+        *d++ = *s++;
+}
+
+/* Hand a message to a receive request. A copy receive gets at most 'bufsize'
+ * bytes copied into 'buf'; a loan receive gets the loaned buffer stored in
+ * *(void **)buf. Returns the number of bytes received, or ERROR for a loan
+ * receive of a message that was copied (it has no buffer to hand over) */
+static int msg_deliver(const void *data, unsigned int size, bool loaned, void *buf, unsigned int bufsize, unsigned int mode) {
+    if (mode == MSG_LOAN) {
+        if (!loaned)
+            return ERROR;
+        *(const void **)buf = data;
+        return size;
+    }
+    if (size > bufsize)
+        size = bufsize;
+    msg_copy(buf, data, size);
+    return size;
+}
+
+#if MAX_MSG_QUEUES > 32
+#error "a receive set has one bit per queue in an unsigned long"
+#endif
+#define ALL_QUEUES  (0xFFFFFFFFUL >> (32 - MAX_MSG_QUEUES))    // receive set of every queue
+
+/* The blocked receive of 'receiver' is over (it has left the waiters): the
+ * designated senders of its receive set drop the priority it passed on, down
+ * to the highest they are still owed by other waiting processes */
+static void senders_restore(pcb *receiver) {
+    unsigned long set = receiver->rcv_set;
+    receiver->rcv_set = 0;                                      // no longer waits on these queues
+    for(unsigned int q = 0; set != 0; q++, set >>= 1) {
+        pcb *sender = msgqueue[q].sender;
+        if((set & 1) && sender != NULL && sender->inherited != 0)
+            priority_update(sender);
+    }
+}
+
+/* Queue a message that could not be handed to a waiting receiver, at the back
+ * of its priority level. A copied message is copied into the container, a
+ * loaned one keeps the sender's buffer */
+static int msg_enqueue(m_queue *queue, void *message, unsigned int msgSize, unsigned int mode, unsigned int priority) {
+    msgcontainer *msg = msg_alloc();                            // take message container from the slab
+    if(msg == NULL)                                             // every container is queued
+        return NO_MEMORY;                                       // return error (message not sent)
+    msg->size = msgSize;                                        // set size field of message container
+    msg->loan = (mode == MSG_LOAN);
+    msg->priority = priority;
+    if(msg->loan)                                               // loaned: keep the sender's buffer
+        msg->msg = (char *)message;
+    else {                                                      // copied: sender may reuse its buffer
+        msg_copy(msg->body, message, msgSize);
+        msg->msg = (char *)msg->body;
+    }
+    queue->enqueue(msg);                                        // queue message in specified message queue
+    return SUCCESS;
+}
+
+/* The message of a blocked sender has been queued or received: its PSendMessage() returns */
+static void send_release(unsigned int queueID, pcb *pcb_ptr) {
+    msgqueue[queueID].senders.dequeue(pcb_ptr);
+    *pcb_ptr->wait_rtn = SUCCESS;                               // result of its send
+    trace(TR_SEND, pcb_ptr->pid, (queueID << 16) | (pcb_ptr->snd_size & 0xFFFF));   // record the event (queue, size)
+    ready_wake(pcb_ptr);
+}
+
+/* A queue has space: the message of its longest waiting blocked sender takes
+ * it, and that sender's PSendMessage() returns. FALSE if no message was queued */
+static bool send_resume(unsigned int queueID) {
+    m_queue *queue = &msgqueue[queueID];
+    pcb *pcb_ptr = queue->senders.get_front();
+    if(pcb_ptr == NULL || queue->full())
+        return FALSE;
+    if(msg_enqueue(queue, pcb_ptr->snd_msg, pcb_ptr->snd_size, pcb_ptr->snd_mode, pcb_ptr->snd_priority) != SUCCESS)
+        return FALSE;                                           // no container: a receive takes it from the sender (receive_set())
+    send_release(queueID, pcb_ptr);
+    return TRUE;
+}
+
+/* Kernel call to send message to destination queue if bound to a process. A
+ * blocked receiver is handed the message directly, otherwise it is queued. If
+ * the queue already holds its capacity of messages, 'full' chooses between
+ * blocking until a receive makes space, failing and overwriting the oldest
+ * (of the lowest level; a message outranked by every queued one fails instead).
+ * Queued messages are received highest 'priority' first */
+signed int KSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize, unsigned int mode, unsigned int full,
+                        unsigned int priority, unsigned long *rtnvalue) {
+    if(destQueueID >= MAX_MSG_QUEUES || priority >= MSG_PRIORITIES) // invalid message queue number or priority
+        return ERROR;
+    if(mode == MSG_COPY && msgSize > MAX_MSG_SIZE)              // too long to copy (may only be loaned)
+        return ERROR;
+    m_queue *queue = &msgqueue[destQueueID];
+    if(queue->members == 0)                                     // queue has no owner (or pool of receivers)
+        return ERROR;
+    pcb *pcb_ptr = queue->shared ? queue->waiters.get_front() : queue->owner;  // receiver to hand the message to
+    int received = ERROR;
+    bool waiting = pcb_ptr != NULL && pcb_ptr->wait_state == WAIT_RECEIVE && (pcb_ptr->rcv_set & QUEUE_BIT(destQueueID));
+    if(waiting)                                                 // receiver is waiting on this queue: straight into its buffer
+        received = msg_deliver(message, msgSize, mode == MSG_LOAN, pcb_ptr->rcv_buf, pcb_ptr->rcv_size, pcb_ptr->rcv_mode);
+    if(received == ERROR) {                                     // not delivered: queue it
+        while(send_resume(destQueueID)) {}                      // space is the blocked senders' first
+        if(queue->full() || !queue->senders.empty()) {          // no space (or no container even for the blocked senders)
+            if(full == SEND_OVERWRITE && queue->full() && priority >= queue->get_lowest()->priority) {
+                queue->stats.overwritten++;                     // drop the oldest message of the lowest level
+                queue->remove(queue->get_lowest());
+            } else if(full != SEND_BLOCK) {                     // fail (an overwrite does not pass blocked senders to free space)
+                if(!queue->full())                              // room, but the containers ran out before the senders queued
+                    return NO_MEMORY;
+                queue->stats.failed_sends++;
+                return QUEUE_FULL;
+            } else {                                            // block until a receive makes space
+                running->snd_msg = message;                     // queued by send_resume()
+                running->snd_size = msgSize;
+                running->snd_mode = mode;
+                running->snd_priority = priority;
+                running->snd_queue = destQueueID;
+                running->wait_rtn = rtnvalue;
+                running->waitlist = &queue->senders;
+                ready_dequeue(running);
+                queue->senders.enqueue(running);
+                running->wait_state = WAIT_SEND;
+                queue->stats.blocked_sends++;
+                TriggerPendSV();                                // switch to next process on exit from SVC
+                trace(TR_BLOCK, running->pid, QUEUE_BIT(destQueueID));  // record the event
+                return 0;                                       // replaced by send_resume() through 'rtnvalue'
+            }
+        }
+        int queued = msg_enqueue(queue, message, msgSize, mode, priority);
+        if(queued != SUCCESS)
+            return queued;
+    }
+    if (waiting) {                                              // if the process to receive the message is blocked on this queue
+        if (received != ERROR && pcb_ptr->rcv_any)              // PReceiveAny(): also say which queue
+            received |= destQueueID << ANY_SHIFT;
+        *pcb_ptr->wait_rtn = received;                          // result of its receive (ERROR if it wanted a loan)
+        pcb_ptr->waitlist->dequeue(pcb_ptr);                    // remove PCB from the waiters it is parked on
+        if (pcb_ptr->sleeping)                                  // receive had a timeout: take it off the timer wheel
+            timer_remove(pcb_ptr);
+        senders_restore(pcb_ptr);                               // wait is over: designated senders drop any inherited priority
+        ready_wake(pcb_ptr);                                    // place PCB in proper queue, preempting if it outranks sender
+    }
+    trace(TR_SEND, running->pid, (destQueueID << 16) | (msgSize & 0xFFFF)); // record the event (queue, size)
+    KPRINT(running->pid, FormatTable[running->pid].send + std::string((char *)message, msgSize > MAX_MSG_SIZE ? MAX_MSG_SIZE : msgSize));
+    return SUCCESS;                                             // return success
+}
+
+/* Receive from the lowest numbered queue of 'set' holding a message (so a process
+ * ranks its queues by number), or block until KSendMessage() delivers to one of
+ * them or 'timeout' ticks pass. Every queue of the set must be bound to the caller.
+ * The caller waits in the waiters of the lowest queue of the set; a shared queue
+ * is waited on alone, so its waiters form the FIFO of its blocked receivers.
+ * A sender still blocked on an empty queue (no container was free when space
+ * was made) hands its message over directly, so it is never left behind
+ * messages sent straight to a receiver that blocked after it.
+ * A PReceiveAny() ('any') result names the queue as well as the byte count */
+static int receive_set(unsigned long set, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout,
+                       unsigned long *rtnvalue, bool any){
+    if(set == 0 || (set & ~ALL_QUEUES) != 0)                    // invalid message queue number(s)
+        return ERROR;
+    if((set & ~running->bound) != 0)                            // a queue of the set is not bound to the caller
+        return ERROR;
+    p_queue *waitlist = NULL;                                   // where the caller waits
+    for(unsigned int q = 0; q < MAX_MSG_QUEUES; q++)
+        if(set & QUEUE_BIT(q)) {
+            if(msgqueue[q].shared && set != QUEUE_BIT(q))       // a PCB joins one FIFO of waiters at a time
+                return ERROR;
+            if(waitlist == NULL)
+                waitlist = &msgqueue[q].waiters;
+        }
+    for(unsigned int q = 0; q < MAX_MSG_QUEUES; q++) {
+        msgcontainer *msg = (set & QUEUE_BIT(q)) ? msgqueue[q].get_front() : NULL;
+        if(msg != NULL) {                                       // if there exists a message in the message queue (receive process)
+            int received = msg_deliver(msg->msg, msg->size, msg->loan, message, msgSize, mode);
+            if(received == ERROR)                               // loan receive of a copied message (left queued)
+                return ERROR;
+            trace(TR_RECEIVE, running->pid, (q << 16) | (received & 0xFFFF));   // record the event (queue, size)
+            KPRINT(running->pid, FormatTable[running->pid].receive + std::string(msg->msg, msg->size > MAX_MSG_SIZE ? MAX_MSG_SIZE : msg->size));
+            msgqueue[q].remove(msg);                            // remove message from message queue and free memory
+            send_resume(q);                                     // a blocked sender may queue its message now
+            return any ? (q << ANY_SHIFT) | received : received;
+        }
+    }
+    for(unsigned int q = 0; q < MAX_MSG_QUEUES; q++) {          // queues are empty: a sender left blocked for want of a
+        pcb *sender = (set & QUEUE_BIT(q)) ? msgqueue[q].senders.get_front() : NULL;   // container hands over its message
+        if(sender != NULL) {
+            int received = msg_deliver(sender->snd_msg, sender->snd_size, sender->snd_mode == MSG_LOAN, message, msgSize, mode);
+            if(received == ERROR)                               // loan receive of a copied message (left with the sender)
+                return ERROR;
+            trace(TR_RECEIVE, running->pid, (q << 16) | (received & 0xFFFF));   // record the event (queue, size)
+            send_release(q, sender);
+            return any ? (q << ANY_SHIFT) | received : received;
+        }
+    }
+    if(timeout == 0)                                            // try-receive: do not wait
+        return WOULD_BLOCK;
+    pcb *pcb_ptr = running;                                     // no message in any queue (block process and perform a context switch)
+    pcb_ptr->rcv_buf = message;                                 // where KSendMessage() delivers the message
+    pcb_ptr->rcv_size = msgSize;
+    pcb_ptr->rcv_mode = mode;
+    pcb_ptr->wait_rtn = rtnvalue;
+    pcb_ptr->rcv_set = set;
+    pcb_ptr->rcv_any = any;
+    pcb_ptr->waitlist = waitlist;
+    ready_dequeue(pcb_ptr);                                     // dequeue process to be blocked
+    waitlist->enqueue(pcb_ptr);                                 // enqueue dequeued process at the back of the waiters
+    pcb_ptr->wait_state = WAIT_RECEIVE;                         // record what the process waits for
+    if(timeout != WAIT_FOREVER)                                 // also wait on the timer wheel (KReceiveExpire())
+        timer_insert(pcb_ptr, ticks + timeout);
+    for(unsigned int q = 0; q < MAX_MSG_QUEUES; q++)            // the processes expected to send run at our priority
+        if(set & QUEUE_BIT(q))
+            priority_inherit(msgqueue[q].sender, pcb_ptr);
+    TriggerPendSV();                                            // switch to next process on exit from SVC
+    trace(TR_BLOCK, running->pid, set);                         // record the event (queues waited on)
+    KPRINT(running->pid, FormatTable[running->pid].blocked); // print diagnostic information to console
+    return 0;                                                   // replaced by the sender through 'rtnvalue'
+}
+
+/* Kernel call to receive message from message queue or block if one not available.
+ * Returns the number of bytes received. A process that blocks is handed the
+ * next message by KSendMessage(), which also returns the count through 'rtnvalue'
+ * (the r0 the caller's kernel call returns) */
+signed int KReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout,
+                           unsigned long *rtnvalue){
+    if(queueID >= MAX_MSG_QUEUES)                               // invalid message queue number
+        return ERROR;
+    return receive_set(QUEUE_BIT(queueID), message, msgSize, mode, timeout, rtnvalue, FALSE);
+}
+
+/* Kernel call to receive a message from whichever of a set of queues has one,
+ * blocking until a message is sent to any of them */
+signed int KReceiveAny(unsigned long queues, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout,
+                       unsigned long *rtnvalue){
+    return receive_set(queues, message, msgSize, mode, timeout, rtnvalue, TRUE);
+}
+
+/* A blocked receive timed out: the timer wheel has taken the PCB off its
+ * slot and wakes it once this returns. O(1): the waiters are doubly linked */
+void KReceiveExpire(pcb *ptr){
+    *ptr->wait_rtn = (unsigned long) TIMEOUT;                    // result of its receive
+    ptr->waitlist->dequeue(ptr);                                // remove PCB from the waiters it is parked on
+    senders_restore(ptr);                                       // wait is over: designated senders drop any inherited priority
+}
+
+/* Hand a rendezvous client's request to its server: copy it straight into the
+ * server's buffer and leave the client waiting for the reply in the queue's
+ * list of received clients. Returns the number of bytes copied */
+static int request_deliver(pcb *client, pcb *server, void *buf, unsigned int bufsize, unsigned long *clientID) {
+    unsigned int size = client->snd_size < bufsize ? client->snd_size : bufsize;
+    msg_copy(buf, client->snd_msg, size);
+    *clientID = pcb_index(client);
+    client->waitlist = &msgqueue[client->snd_queue].awaiting;
+    client->waitlist->enqueue(client);
+    client->wait_state = WAIT_REPLY;
+    trace(TR_RECEIVE, server->pid, (client->snd_queue << 16) | (size & 0xFFFF));  // record the event (queue, size)
+    return size;
+}
+
+/* Kernel call sending a request to the owner of a queue and waiting for its
+ * reply (rendezvous). Neither message is queued: the request is copied from
+ * the caller's buffer into the server's when it receives it, and the reply
+ * from the server's buffer into 'reply' by KReply(), which returns its size
+ * through 'rtnvalue'. The server runs at (at least) the caller's priority
+ * until it replies */
+int KSendReceive(unsigned int queueID, void *request, unsigned int reqSize, void *reply, unsigned int replySize,
+                 unsigned long *rtnvalue){
+    if(queueID >= MAX_MSG_QUEUES)                               // invalid message queue number
+        return ERROR;
+    m_queue *queue = &msgqueue[queueID];
+    pcb *server = queue->owner;                                 // rendezvous is with an exclusive owner
+    if(server == NULL || server == running)
+        return ERROR;
+    running->snd_msg = request;
+    running->snd_size = reqSize;
+    running->snd_queue = queueID;
+    running->rcv_buf = reply;                                   // where KReply() copies the reply
+    running->rcv_size = replySize;
+    running->wait_rtn = rtnvalue;
+    ready_dequeue(running);                                     // caller waits for the server
+    trace(TR_SEND, running->pid, (queueID << 16) | (reqSize & 0xFFFF));   // record the event (queue, size)
+    priority_inherit(server, running);                          // server works for us at our priority
+    if(server->wait_state == WAIT_REQUEST && (server->rcv_set & QUEUE_BIT(queueID))) {
+        *server->wait_rtn = request_deliver(running, server, server->rcv_buf, server->rcv_size, server->rcv_client);
+        server->waitlist->dequeue(server);
+        ready_wake(server);
+    } else {                                                    // server busy: wait to be received
+        running->wait_state = WAIT_CALL;
+        running->waitlist = &queue->clients;
+        queue->clients.enqueue(running);
+        trace(TR_BLOCK, running->pid, QUEUE_BIT(queueID));      // record the event
+    }
+    TriggerPendSV();                                            // switch to next process on exit from SVC
+    return 0;                                                   // replaced by KReply() through 'rtnvalue'
+}
+
+/* Kernel call receiving the next rendezvous request sent to a queue owned by
+ * 'running', blocking until one is sent. '*clientID' names the client to reply to */
+int KReceiveRequest(unsigned int queueID, void *request, unsigned int reqSize, unsigned long *clientID,
+                    unsigned long *rtnvalue){
+    if(queueID >= MAX_MSG_QUEUES || msgqueue[queueID].owner != running)
+        return ERROR;                                           // not the caller's queue
+    m_queue *queue = &msgqueue[queueID];
+    pcb *client = queue->clients.get_front();                   // longest waiting client
+    if(client != NULL) {
+        queue->clients.dequeue(client);
+        return request_deliver(client, running, request, reqSize, clientID);
+    }
+    running->rcv_buf = request;                                 // where KSendReceive() delivers the request
+    running->rcv_size = reqSize;
+    running->rcv_client = clientID;
+    running->rcv_set = QUEUE_BIT(queueID);
+    running->wait_rtn = rtnvalue;
+    running->waitlist = &queue->waiters;
+    ready_dequeue(running);
+    queue->waiters.enqueue(running);
+    running->wait_state = WAIT_REQUEST;
+    TriggerPendSV();                                            // switch to next process on exit from SVC
+    trace(TR_BLOCK, running->pid, QUEUE_BIT(queueID));          // record the event
+    return 0;                                                   // replaced by KSendReceive() through 'rtnvalue'
+}
+
+/* Kernel call replying to a rendezvous client received by 'running'. The reply
+ * is copied straight into the client's buffer and the client made ready. An
+ * inherited priority drops to the highest the server is still owed */
+int KReply(unsigned long clientID, void *reply, unsigned int replySize){
+    pcb *client = pcb_at(clientID);
+    if(client == NULL || client->wait_state != WAIT_REPLY || msgqueue[client->snd_queue].owner != running)
+        return ERROR;                                           // not a client waiting on the caller
+    unsigned int size = replySize < client->rcv_size ? replySize : client->rcv_size;
+    msg_copy(client->rcv_buf, reply, size);
+    *client->wait_rtn = size;                                   // result of its PSendReceive()
+    client->waitlist->dequeue(client);                          // off the queue's received clients
+    trace(TR_SEND, running->pid, (client->snd_queue << 16) | (size & 0xFFFF));  // record the event (queue, size)
+    if(running->inherited != 0)                                 // may have inherited from this client
+        priority_update(running);
+    ready_wake(client);                                         // preempts us if it outranks us
+    return SUCCESS;
+}
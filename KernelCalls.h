@@ -1,35 +1,57 @@
-/*
- * File: KernelCalls.h
- * Author: Stephen Sampson and Mason Butler
- * Original Date: October 2nd 2017
- * Revised Date: December 5th 2017
- * Purpose: Define structure used to send arguements to the kernel as well as
- *          functions called from the kernel, not to be interrupted
- */
-
-#pragma once                            // ensure file is included only once in compilation
-
-#include "queues.h"                     // kernel needs to access process and message queues
-
-/* Enumeration for kernel codes to improve readability and eliminate 'magic' numbers */
-enum kernelcallcodes {GETID, BIND, SEND, RECEIVE, TERMINATE};
-
-struct kcallargs {
-    unsigned int code;                  // action (from enumeration table above) to perform
-    unsigned int arg1;                  // arg1 (if applicable)
-    unsigned int arg2;                  // arg2 (if applicable)
-    int rtnvalue;                       // value returned by kernel to calling process (neg = error)
-};
-
-void KTerminateProcess(void);           // Kernel call to terminate 'running' process
-unsigned int KGetPID();                 // Kernel call to get PID of 'runnign' process
-
-/**********************************************************************************************************
- * Mason Butler originally authored the functions below. Testing and modifications by Stephen Sampson
- *********************************************************************************************************/
-
-int KBind(unsigned int queue_num);      // Kernel call to bind process to specified message queue
-/*Kernel call to send message to destination queue if bound to a process */
-int KSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize);
-/* Kernel call to receive message from message queue if one exists, else block until message queue receives a message */
-int KReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize);
+/*
+ * File: KernelCalls.h
+ * Author: Stephen Sampson and Mason Butler
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Define structure used to send arguements to the kernel as well as
+ *          functions called from the kernel, not to be interrupted
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "queues.h"                     // kernel needs to access process and message queues
+
+#define NO_SENDER   0xFFFFFFFF          // PID that clears the designated sender of a queue
+
+/* Enumeration for kernel codes to improve readability and eliminate 'magic' numbers */
+/* The code is passed to the kernel in r12 and up to four arguments in r0-r3 (see pkCall()) */
+enum kernelcallcodes {GETID, BIND, SEND, RECEIVE, TERMINATE, SLEEP, YIELD, STATS, WAITPERIOD, DESIGNATE, RECEIVEANY, WAITREPORT, QUEUESTATS,
+                      SENDRECEIVE, RECEIVEREQUEST, REPLY, NUM_KCALLS};
+
+void KTerminateProcess(void);           // Kernel call to terminate 'running' process
+unsigned int KGetPID();                 // Kernel call to get PID of 'runnign' process
+int KSleep(unsigned int sleep_ticks);   // Kernel call to put 'running' process to sleep for a number of ticks
+int KYield(void);                       // Kernel call to give the rest of the quantum to the next process of the same priority
+int KProcStats(procstats *stats);       // Kernel call to get CPU and stack usage of the process stats->pid
+int KWaitReport(waitinfo *list, unsigned int max);  // Kernel call to list what every waiting process waits for
+int KQueueStats(unsigned int queue_num, queuestats *stats); // Kernel call to get the occupancy of a message queue
+int KWaitNextPeriod(void);              // Kernel call to end the job of 'running' (EDF) and wait for its next release
+
+/**********************************************************************************************************
+ * Mason Butler originally authored the functions below. Testing and modifications by Stephen Sampson
+ *********************************************************************************************************/
+
+int KBind(unsigned int queue_num, unsigned int mode, unsigned int capacity);    // Kernel call to bind process to specified message queue
+/* Kernel call to name the process expected to send to a queue owned by 'running' (NO_SENDER to clear) */
+int KDesignateSender(unsigned int queue_num, unsigned long pid);
+/*Kernel call to send message to destination queue if bound to a process, received ahead of queued messages of lower
+ * 'priority'. 'full' picks what a send to a queue at capacity does; a send that blocks has its result returned through 'rtnvalue' once the message is queued */
+int KSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize, unsigned int mode, unsigned int full,
+                 unsigned int priority, unsigned long *rtnvalue);
+/* Kernel call to receive message from message queue if one exists, else block until message queue receives a message
+ * or 'timeout' ticks pass (0: return WOULD_BLOCK at once, WAIT_FOREVER: no timeout).
+ * Returns the number of bytes received; if the caller blocks, the sender (or timeout) returns it through 'rtnvalue' */
+int KReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout,
+                    unsigned long *rtnvalue);
+/* Kernel call to receive from whichever queue of the set 'queues' (QUEUE_BIT() of each) has a message first.
+ * Returns the queue and byte count (ANY_QUEUE()/ANY_BYTES()) */
+int KReceiveAny(unsigned long queues, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout,
+                unsigned long *rtnvalue);
+void KReceiveExpire(pcb *ptr);          // timeout of a blocked receive (called by the timer wheel)
+/* Rendezvous: send a request to the owner of a queue and wait for its reply (its size is returned through 'rtnvalue') */
+int KSendReceive(unsigned int queueID, void *request, unsigned int reqSize, void *reply, unsigned int replySize,
+                 unsigned long *rtnvalue);
+/* Rendezvous: receive the next request sent to a queue owned by 'running', naming its client in '*clientID' */
+int KReceiveRequest(unsigned int queueID, void *request, unsigned int reqSize, unsigned long *clientID,
+                    unsigned long *rtnvalue);
+int KReply(unsigned long clientID, void *reply, unsigned int replySize);    // Rendezvous: reply to a received client
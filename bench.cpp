@@ -0,0 +1,345 @@
+/*
+ * File: bench.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: See bench.h. Samples of the running benchmark are kept in one
+ *          buffer and reduced to min/mean/p99/max when it reports.
+ */
+
+#include "bench.h"
+#include "globals.h"
+#include "process.h"
+#include "kernel.h"
+#include "uart.h"
+
+static unsigned long samples[BENCH_SAMPLES];    // samples of the running benchmark
+static unsigned int nsamples = 0;               // number taken so far
+static unsigned long overhead = 0;              // cycles taken by a pair of CYCLES() reads
+static volatile unsigned long stamp;            // cycle count taken before a switch, read after it
+static unsigned long victim_pid;                // PID label shared by every terminate victim
+static volatile bool switch_done = FALSE;       // last switch sample taken
+static unsigned long inv_low_pid;               // PID of the inversion low priority process
+static volatile bool inv_med_waiting = FALSE;   // inversion medium priority process is waiting to be started
+static volatile bool rdv_med_waiting = FALSE;   // rendezvous medium priority process is waiting to be started
+static volatile bool finished = FALSE;          // last benchmark has reported
+
+/* Record one sample, less the cost of timing it */
+static void bench_record(unsigned long cycles) {
+    if (nsamples < BENCH_SAMPLES)
+        samples[nsamples++] = cycles > overhead ? cycles - overhead : 0;
+}
+
+/* Sort the samples and print BENCH,<name>,<samples>,<min>,<mean>,<p99>,<max>.
+ * Returns the median sample */
+static unsigned long bench_report(const char *name) {
+    unsigned long total = 0;
+    for (unsigned int gap = nsamples / 2; gap > 0; gap /= 2)    // shell sort
+        for (unsigned int i = gap; i < nsamples; i++)
+            for (unsigned int j = i; j >= gap && samples[j - gap] > samples[j]; j -= gap) {
+                unsigned long t = samples[j];
+                samples[j] = samples[j - gap];
+                samples[j - gap] = t;
+            }
+    for (unsigned int i = 0; i < nsamples; i++)
+        total += samples[i];
+    UART0_printf("\n\rBENCH,");
+    UART0_printf(name);
+    UART0_printf(",");
+    UART0_printnum(nsamples);
+    if (nsamples != 0) {
+        UART0_printf(",");
+        UART0_printnum(samples[0]);
+        UART0_printf(",");
+        UART0_printnum(total / nsamples);
+        UART0_printf(",");
+        UART0_printnum(samples[(nsamples * 99) / 100]);
+        UART0_printf(",");
+        UART0_printnum(samples[nsamples - 1]);
+    }
+    unsigned long median = (nsamples != 0) ? samples[nsamples / 2] : 0;
+    nsamples = 0;
+    return median;
+}
+
+/* pkCall(GETID) round trip. Runs first, so it also measures the timing overhead */
+static void bench_getid(void) {
+    overhead = 0xFFFFFFFF;
+    for (int i = 0; i < 100; i++) {
+        unsigned long start = CYCLES();
+        unsigned long cycles = CYCLES() - start;
+        if (cycles < overhead)
+            overhead = cycles;
+    }
+    UART0_printf("\n\rBENCH,name,samples,min,mean,p99,max");
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        unsigned long start = CYCLES();
+        PGetPID();
+        bench_record(CYCLES() - start);
+    }
+    bench_report("getid");
+}
+
+/* Two of these yield to each other. Each resumes right after the other took
+ * its stamp and yielded, so a sample is one SVC + PendSV switch */
+static void bench_switch(void) {
+    while (!switch_done) {
+        stamp = CYCLES();
+        PYield();
+        if (switch_done)                    // other process took the last sample
+            break;
+        bench_record(CYCLES() - stamp);
+        if (nsamples == BENCH_SAMPLES) {
+            switch_done = TRUE;
+            bench_report("switch");
+        }
+    }
+}
+
+/* Ping-pong server: answer every message until the client sends an empty one */
+static void bench_pong(void) {
+    unsigned int my_queue = PBind(BENCH_PONG_QUEUE);
+    char msg[4];
+    while (PReceiveMessage(my_queue, msg, sizeof(msg)) > 0)
+        PSendMessage(BENCH_PING_QUEUE, msg, sizeof(msg));
+}
+
+/* Ping-pong client: a sample is a send plus a receive of the answer */
+static void bench_ping(void) {
+    unsigned int my_queue = PBind(BENCH_PING_QUEUE);
+    char msg[4] = "PNG";
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        unsigned long start = CYCLES();
+        PSendMessage(BENCH_PONG_QUEUE, msg, sizeof(msg));
+        PReceiveMessage(my_queue, msg, sizeof(msg));
+        bench_record(CYCLES() - start);
+    }
+    PSendMessage(BENCH_PONG_QUEUE, msg, 0);   // stop the server
+    bench_report("pingpong");
+}
+
+/* Block/unblock receiver. Blocks on an empty queue and outranks the sender, so
+ * a sample is the send, the wakeup and the switch back to it */
+static void bench_wake(void) {
+    unsigned int my_queue = PBind(BENCH_WAKE_QUEUE);
+    char msg[4];
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        PReceiveMessage(my_queue, msg, sizeof(msg));
+        bench_record(CYCLES() - stamp);
+    }
+    bench_report("wake");
+}
+
+/* Block/unblock sender. Only runs while the receiver is blocked */
+static void bench_sender(void) {
+    char msg[4] = "WAK";
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        stamp = CYCLES();
+        PSendMessage(BENCH_WAKE_QUEUE, msg, sizeof(msg));
+    }
+}
+
+/* Terminate victim: runs as soon as it is registered and returns straight
+ * into PTerminateProcess() */
+static void bench_victim(void) {
+    stamp = CYCLES();
+}
+
+/* Registers the victims one at a time. A sample is the victim's termination,
+ * returning its PCB and stack to the pools and the switch back here */
+static void bench_spawner(void) {
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        GIntDisable();                      // reg_proc() changes the ready queues
+        int rtn = reg_proc(bench_victim, victim_pid, BENCH_PRI_VICTIM);
+        GIntEnable();
+        if (rtn != SUCCESS)
+            break;
+        PYield();                           // victim outranks us: it runs and terminates
+        bench_record(CYCLES() - stamp);
+    }
+    bench_report("terminate");
+}
+
+/* Priority inversion, high priority process. A sample is the time from asking
+ * the low priority process for a reply until it arrives, with the medium
+ * priority process started just before. Without inheritance the medium
+ * process runs first and the reply waits BENCH_INV_WORK cycles. The second
+ * pass designates the low priority process as the sender of our queue */
+static void bench_inv_high(void) {
+    unsigned int my_queue = PBind(BENCH_INV_QUEUE);
+    char msg[4] = "REQ";
+    PSleep(1);                              // let the others bind their queues
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1)
+            PDesignateSender(my_queue, inv_low_pid);
+        for (int i = 0; i < BENCH_INV_SAMPLES; i++) {
+            if (inv_med_waiting) {          // start the medium process (it runs once we block)
+                inv_med_waiting = FALSE;
+                PSendMessage(BENCH_INV_MED_QUEUE, msg, sizeof(msg));
+            }
+            unsigned long start = CYCLES();
+            PSendMessage(BENCH_INV_LOW_QUEUE, msg, sizeof(msg));
+            PReceiveMessage(my_queue, msg, sizeof(msg));
+            bench_record(CYCLES() - start);
+        }
+        bench_report(pass == 0 ? "inversion" : "inversion_pi");
+    }
+    PSendMessage(BENCH_INV_MED_QUEUE, msg, 0);  // stop the others
+    PSendMessage(BENCH_INV_LOW_QUEUE, msg, 0);
+    PSendMessage(BENCH_URGENT_QUEUE, msg, 0);   // start the urgent message benchmark
+}
+
+/* Medium priority process of an inversion: busy for BENCH_INV_WORK cycles each
+ * time a message to 'queue' starts it, until an empty one stops it */
+static void bench_busy(unsigned int queue, volatile bool *waiting) {
+    unsigned int my_queue = PBind(queue);
+    char msg[4];
+    while (TRUE) {
+        *waiting = TRUE;
+        if (PReceiveMessage(my_queue, msg, sizeof(msg)) <= 0)
+            break;
+        unsigned long start = CYCLES();
+        while ((unsigned int)(CYCLES() - start) < BENCH_INV_WORK) {}
+    }
+}
+
+/* Priority inversion, medium priority process */
+static void bench_inv_med(void) {
+    bench_busy(BENCH_INV_MED_QUEUE, &inv_med_waiting);
+}
+
+/* Priority inversion, low priority process: answers every request */
+static void bench_inv_low(void) {
+    unsigned int my_queue = PBind(BENCH_INV_LOW_QUEUE);
+    char msg[4];
+    while (PReceiveMessage(my_queue, msg, sizeof(msg)) > 0)
+        PSendMessage(BENCH_INV_QUEUE, msg, sizeof(msg));
+}
+
+/* Urgent message latency. A sample is an MSG_URGENT send to our own queue and
+ * the receive that takes it, with no routine messages queued ahead of it and
+ * then with BENCH_URGENT_BACKLOG of them. The urgent message is received
+ * first either way, so the two should take the same time */
+static void bench_urgent(void) {
+    unsigned int my_queue = PBind(BENCH_URGENT_QUEUE);
+    char msg[4] = "URG";
+    PReceiveMessage(my_queue, msg, sizeof(msg));    // wait for the inversion benchmark to finish
+    for (int pass = 0; pass < 2; pass++) {
+        int backlog = (pass == 0) ? 0 : BENCH_URGENT_BACKLOG;
+        for (int i = 0; i < BENCH_URGENT_SAMPLES; i++) {
+            for (int j = 0; j < backlog; j++)
+                PSendMessage(my_queue, msg, sizeof(msg));
+            unsigned long start = CYCLES();
+            PSendMessage(my_queue, msg, sizeof(msg), MSG_COPY, SEND_BLOCK, MSG_URGENT);
+            PReceiveMessage(my_queue, msg, sizeof(msg));
+            bench_record(CYCLES() - start);
+            while (PTryReceive(my_queue, msg, sizeof(msg)) > 0) {}  // drain the backlog
+        }
+        bench_report(pass == 0 ? "urgent" : "urgent_backlog");
+    }
+    PSendMessage(BENCH_RDV_START, msg, 0);  // start the rendezvous benchmark
+}
+
+/* Rendezvous server: reply to every request until a client sends an empty one */
+static void bench_rdv_server(void) {
+    unsigned int my_queue = PBind(BENCH_RDV_QUEUE);
+    unsigned long client;
+    char msg[4];
+    while (PReceiveRequest(my_queue, msg, sizeof(msg), &client) > 0)
+        PReply(client, msg, sizeof(msg));
+    PReply(client, msg, 0);
+}
+
+/* Rendezvous, medium priority process */
+static void bench_rdv_med(void) {
+    bench_busy(BENCH_RDV_MED_QUEUE, &rdv_med_waiting);
+}
+
+/* Rendezvous, low priority server: takes the first client's request and then
+ * the second client's, and replies to the second first. It must keep the
+ * priority of the first client until that reply too, or the medium priority
+ * process runs ahead of it */
+static void bench_rdv_low(void) {
+    unsigned int my_queue = PBind(BENCH_RDV_LOW_QUEUE);
+    unsigned long first, second;
+    char msg[4];
+    while (PReceiveRequest(my_queue, msg, sizeof(msg), &first) > 0) {
+        PReceiveRequest(my_queue, msg, sizeof(msg), &second);
+        PReply(second, msg, sizeof(msg));
+        PReply(first, msg, sizeof(msg));
+    }
+    PReply(first, msg, 0);
+}
+
+/* Rendezvous, second client: calls the low priority server each time it is started */
+static void bench_rdv_peer(void) {
+    unsigned int my_queue = PBind(BENCH_RDV_PEER_QUEUE);
+    char msg[4];
+    while (PReceiveMessage(my_queue, msg, sizeof(msg)) > 0)
+        PSendReceive(BENCH_RDV_LOW_QUEUE, msg, sizeof(msg), msg, sizeof(msg));
+}
+
+/* Rendezvous client: a sample is a PSendReceive() of a request the size of a
+ * ping-pong message, to compare with the two queue round trip (pingpong). The
+ * second pass calls the low priority server with the medium priority process
+ * ready and the second client calling too; a median reply time of
+ * BENCH_INV_WORK cycles or more means the medium process ran first, and is
+ * reported as BENCH,fail,rendezvous_pi */
+static void bench_rdv_client(void) {
+    unsigned int my_queue = PBind(BENCH_RDV_START);
+    char msg[4] = "RDV";
+    PReceiveMessage(my_queue, msg, sizeof(msg));    // wait for the urgent message benchmark to finish
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        unsigned long start = CYCLES();
+        PSendReceive(BENCH_RDV_QUEUE, msg, sizeof(msg), msg, sizeof(msg));
+        bench_record(CYCLES() - start);
+    }
+    PSendReceive(BENCH_RDV_QUEUE, msg, 0, msg, sizeof(msg));    // stop the server
+    bench_report("rendezvous");
+    PSleep(1);                              // let the others bind their queues
+    for (int i = 0; i < BENCH_INV_SAMPLES; i++) {
+        if (rdv_med_waiting) {              // start the medium process (it runs if the server drops below it)
+            rdv_med_waiting = FALSE;
+            PSendMessage(BENCH_RDV_MED_QUEUE, msg, sizeof(msg));
+        }
+        PSendMessage(BENCH_RDV_PEER_QUEUE, msg, sizeof(msg));   // second client calls once we block
+        unsigned long start = CYCLES();
+        PSendReceive(BENCH_RDV_LOW_QUEUE, msg, sizeof(msg), msg, sizeof(msg));
+        bench_record(CYCLES() - start);
+    }
+    PSendMessage(BENCH_RDV_MED_QUEUE, msg, 0);  // stop the others
+    PSendMessage(BENCH_RDV_PEER_QUEUE, msg, 0);
+    PSendReceive(BENCH_RDV_LOW_QUEUE, msg, 0, msg, sizeof(msg));
+    if (bench_report("rendezvous_pi") >= BENCH_INV_WORK)
+        UART0_printf("\n\rBENCH,fail,rendezvous_pi");
+    UART0_printf("\n\rBENCH,done\n\r");
+    finished = TRUE;
+}
+
+/* Every benchmark has reported */
+bool bench_finished(void) {
+    return finished;
+}
+
+/* Register the benchmark processes. The idle process must already be registered */
+void bench_register(void) {
+    reg_proc(bench_getid, next_pid, BENCH_PRI_GETID);
+    reg_proc(bench_switch, next_pid, BENCH_PRI_SWITCH);
+    reg_proc(bench_switch, next_pid, BENCH_PRI_SWITCH);
+    reg_proc(bench_pong, next_pid, BENCH_PRI_PINGPONG);         // server blocks before the first ping
+    reg_proc(bench_ping, next_pid, BENCH_PRI_PINGPONG);
+    reg_proc(bench_wake, next_pid, BENCH_PRI_WAKE);
+    reg_proc(bench_sender, next_pid, BENCH_PRI_SENDER);
+    reg_proc(bench_spawner, next_pid, BENCH_PRI_SPAWNER);
+    reg_proc(bench_inv_high, next_pid, BENCH_PRI_INV_HIGH);
+    reg_proc(bench_inv_med, next_pid, BENCH_PRI_INV_MED);
+    inv_low_pid = next_pid;
+    reg_proc(bench_inv_low, next_pid, BENCH_PRI_INV_LOW);
+    reg_proc(bench_urgent, next_pid, BENCH_PRI_URGENT);
+    reg_proc(bench_rdv_server, next_pid, BENCH_PRI_RDV);        // server blocks before the first request
+    reg_proc(bench_rdv_client, next_pid, BENCH_PRI_RDV);
+    reg_proc(bench_rdv_peer, next_pid, BENCH_PRI_RDV);
+    reg_proc(bench_rdv_med, next_pid, BENCH_PRI_RDV_MED);
+    reg_proc(bench_rdv_low, next_pid, BENCH_PRI_RDV_LOW);
+    victim_pid = next_pid;                  // every victim reuses this PID
+}
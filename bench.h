@@ -0,0 +1,56 @@
+/*
+ * File: bench.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Kernel microbenchmark suite, registered in place of the dummy
+ *          processes when BENCHMARK is set. Each benchmark is a group of
+ *          processes at its own priority level so the groups run one after
+ *          another, highest first. Every sample is timed with the DWT cycle
+ *          counter (less the cost of reading it) and each benchmark reports
+ *          one machine readable line over UART0 once it has finished:
+ *              BENCH,<name>,<samples>,<min>,<mean>,<p99>,<max>
+ *          with all times in CPU cycles, followed by BENCH,done at the end.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#define BENCHMARK       FALSE           // register the benchmark suite instead of the dummy processes
+#define BENCH_SAMPLES   1000            // samples taken by each benchmark
+
+/* Priority of each benchmark group (groups run highest first) */
+#define BENCH_PRI_GETID     31          // pkCall(GETID) round trip
+#define BENCH_PRI_SWITCH    30          // PYield() between two processes: SVC + PendSV switch
+#define BENCH_PRI_PINGPONG  24          // send/receive round trip between two processes
+#define BENCH_PRI_WAKE      17          // receiver blocking / being woken by a send ...
+#define BENCH_PRI_SENDER    16          // ... from a lower priority sender
+#define BENCH_PRI_VICTIM    10          // processes that terminate as soon as they run ...
+#define BENCH_PRI_SPAWNER   9           // ... registered one at a time by the spawner
+#define BENCH_PRI_INV_HIGH  7           // priority inversion: waits for a reply from ...
+#define BENCH_PRI_INV_MED   6           // ... (while this one runs BENCH_INV_WORK cycles) ...
+#define BENCH_PRI_INV_LOW   5           // ... this one, with and without priority inheritance
+#define BENCH_PRI_URGENT    4           // urgent message send/receive behind a backlog of routine messages
+#define BENCH_PRI_RDV       3           // PSendReceive()/PReply() round trip between two processes, then two clients of ...
+#define BENCH_PRI_RDV_MED   2           // ... (while this one is ready to run BENCH_INV_WORK cycles) ...
+#define BENCH_PRI_RDV_LOW   1           // ... this server, which must inherit their priority
+
+#define BENCH_PING_QUEUE    12          // queue of the ping-pong client
+#define BENCH_PONG_QUEUE    13          // queue of the ping-pong server
+#define BENCH_WAKE_QUEUE    14          // queue of the block/unblock receiver
+#define BENCH_INV_QUEUE     9           // queue of the inversion high priority process
+#define BENCH_INV_MED_QUEUE 10          // queue of the inversion medium priority process
+#define BENCH_INV_LOW_QUEUE 11          // queue of the inversion low priority process
+#define BENCH_URGENT_QUEUE  8           // queue of the urgent message process
+#define BENCH_RDV_QUEUE     6           // queue of the rendezvous server
+#define BENCH_RDV_START     7           // queue the rendezvous client waits on to start
+#define BENCH_RDV_MED_QUEUE 5           // queue of the rendezvous medium priority process
+#define BENCH_RDV_LOW_QUEUE 4           // queue of the rendezvous low priority server
+#define BENCH_RDV_PEER_QUEUE 3          // queue the second rendezvous client waits on to call
+
+#define BENCH_INV_SAMPLES   100         // samples taken in each inversion pass
+#define BENCH_INV_WORK      100000      // cycles the medium priority process runs each time it is started
+#define BENCH_URGENT_SAMPLES 100        // samples taken in each urgent message pass
+#define BENCH_URGENT_BACKLOG 48         // routine messages queued ahead of the urgent one in the second pass
+
+void bench_register(void);              // register the benchmark processes (after the idle process)
+bool bench_finished(void);              // every benchmark has reported
@@ -0,0 +1,122 @@
+/*
+ * File: cortexm4.cpp
+ * Original Source: http://lh.ece.dal.ca/eced4402/
+ * Modified By: Stephen Sampson
+ * Revised Date: December 5th 2017
+ * Purpose: Cortex-M4 port of the kernel. The only code that touches core
+ *          registers directly: stack pointer access, saving and restoring
+ *          r4-r11, the kernel call trap, the SVC entry point and the first
+ *          switch to thread mode.
+ *          The hosted build (host/) provides the same functions on Linux.
+ */
+
+#include "process.h"
+#include "globals.h"
+
+/* Returns contents of PSP (current process stack */
+unsigned long get_PSP(void) {
+    __asm(" mrs     r0, psp");
+    __asm(" bx  lr");
+    return 0;
+}
+
+/* Returns contents of MSP (main stack) */
+unsigned long get_MSP(void) {
+    __asm(" mrs     r0, msp");
+    __asm(" bx  lr");
+    return 0;
+}
+
+/* set PSP to ProcessStack */
+void set_PSP(volatile unsigned long ProcessStack) {
+    __asm(" msr psp, r0");
+}
+
+/* Set MSP to MainStack */
+void set_MSP(volatile unsigned long MainStack) {
+    __asm(" msr msp, r0");
+}
+
+/* Save r4..r11 on process stack */
+void save_registers() {
+    __asm(" mrs     r0,psp");
+    __asm(" stmdb   r0!,{r4-r11}");
+    __asm(" msr psp,r0");
+}
+
+/* Restore r4..r11 from stack to CPU */
+void restore_registers() {
+    __asm(" mrs r0,psp");
+    __asm(" ldmia   r0!,{r4-r11}");
+    __asm(" msr psp,r0");
+}
+
+/* Get stack pointer */
+unsigned long get_SP() {
+    __asm("     mov     r0,SP");
+    __asm(" bx  lr");
+    return 0;
+}
+
+/* Kernel call, int kcall(arg1, arg2, arg3, arg4, code) (process.h). Written
+ * as a standalone assembly routine so that no compiler prologue, at any
+ * optimisation level, can move SP before the code is read. arg1-arg4 are
+ * already in r0-r3 (AAPCS) and are stacked by the SVC exception where
+ * SVCHandler() finds them; the fifth argument, the code, is the word at SP
+ * on entry and goes in r12. SVCHandler() leaves the result in the stacked r0,
+ * which the exception return restores into r0 */
+__asm("     .text");
+__asm("     .thumb");
+__asm("     .global kcall");
+__asm("     .thumbfunc kcall");
+__asm("kcall: .asmfunc");
+__asm("     ldr     r12,[sp]");     // code
+__asm("     svc     #0");
+__asm("     bx      lr");           // r0 holds the kernel's return value
+__asm("     .endasmfunc");
+
+/* Supervisor call (trap) entry point. Kernel calls only need the hardware
+ * frame, so r4-r11 are not stacked: SVCHandler() is given the address they
+ * would occupy below the PSP and must only use r0-r3, r12 of the frame (being
+ * C, it preserves r4-r11 itself). If the call wants a context switch,
+ * SVCHandler() returns non-zero and the handler continues as PendSVHandler(),
+ * which spills r4-r11 once and is the only place processes are switched */
+extern "C" void SVCall(void) {
+
+    /* Trapping source: MSP or PSP? */
+    __asm("     TST     LR,#4");        // Bit #4 indicates MSP (0) or PSP (1)
+    __asm("     BEQ     RtnViaMSP");
+
+    /* Trapping source is PSP - kernel call */
+    __asm("     PUSH    {LR}");
+    __asm("     mrs     r0,psp");
+    __asm("     sub     r0,r0,#32");    // frame base (r4-r11 slots left unwritten)
+    __asm("     BL  SVCHandler");
+    __asm("     POP     {LR}");
+    __asm("     CMP     r0,#0");
+    __asm("     BNE     PendSVHandler");// slow path: switch on the way out (returns via LR)
+    __asm("     BX      LR");           // fast path: straight back to the caller
+
+    /* Trapping source is MSP (first SVC from main()) - save r4-r11 on stack */
+    __asm("RtnViaMSP:");
+    __asm("     PUSH    {LR}");
+    __asm("     PUSH    {r4-r11}");
+    __asm("     MRS r0,msp");
+    __asm("     BL  SVCHandler");       // r0 is MSP
+    __asm("     POP {r4-r11}");
+    __asm("     POP     {PC}");
+
+}
+
+/* Enter the first process: PSP points past the software saved r4-r11 to the
+ * hardware frame built by reg_proc() and the exception returns through it */
+void start_process(unsigned long sp) {
+
+    /* Ensure PSP points to the address of R0 */
+    set_PSP(sp + 8 * sizeof(unsigned int));
+
+    /* Change LR to indicate return to Thread mode using the PSP */
+    __asm(" movw    LR,#0xFFFD");   // Lower 16 [and clear top 16]
+    __asm(" movt    LR,#0xFFFF");   // Upper 16 only
+    __asm(" bx  LR");               // Force return to PSP
+}
@@ -0,0 +1,367 @@
+/*
+ * File: hostport.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: See hostport.h. Host versions of the functions cortexm4.cpp
+ *          provides on the target, the simulated register file, and the
+ *          model of SVC, SysTick and PendSV.
+ *          A process's 'sp' is the frame reg_proc() built at the top of its
+ *          stack until it first runs, after which it is its ucontext. All
+ *          switches happen in PendSVHandler(): save_registers() notes the
+ *          outgoing context and restore_registers() swaps to the incoming one.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "process.h"
+#include "globals.h"
+#include "svc.h"
+#include "systick.h"
+#include "KernelCalls.h"
+
+/* Target addresses of registers with side effects */
+#define HOST_NVIC_INT_CTRL  0xE000ED04
+#define HOST_ST_CTRL        0xE000E010
+#define HOST_ST_RELOAD      0xE000E014
+#define HOST_ST_CURRENT     0xE000E018
+#define HOST_DWT_CYCCNT     0xE0001004
+#define HOST_UART0_DR       0x4000C000
+#define HOST_UART0_FR       0x4000C018
+#define HOST_UART0_MIS      0x4000C040
+
+#define HOST_REGS           64          // registers the simulated register file can hold
+#define HOST_UART_FILE      "uart0.out" // UART0 output (override with HOST_UART in the environment)
+
+/* Simulated register file */
+static unsigned long regaddr[HOST_REGS];
+static unsigned long regval[HOST_REGS];
+static int nregs = 0;
+
+/* Exception model */
+static volatile sig_atomic_t in_handler = 0;    // SVC, SysTick or PendSV is running
+static volatile sig_atomic_t irq_masked = 0;    // interrupts disabled (cpsid i)
+static volatile int ticks_pending = 0;          // SysTick interrupts waiting to be taken
+static volatile sig_atomic_t st_counted = 0;    // ST_CTRL COUNTFLAG: SysTick wrapped since last read
+static bool started = FALSE;                    // first process has been entered
+
+/* Process contexts */
+static ucontext_t ctxpool[PCB_POOL_SIZE];       // one per PCB that has run
+static ucontext_t *ctxfree[PCB_POOL_SIZE];      // free contexts
+static int nctxfree = -1;                       // -1 until the free list is built
+static ucontext_t main_ctx;                     // main(), left for good by start_process()
+static unsigned long host_psp = 0;              // 'process stack pointer': frame or context of running
+static unsigned long host_from = 0;             // context being switched out by PendSVHandler()
+static bool from_dead = FALSE;                  // ...and it has terminated (never resumed)
+static stack_frame *entry_frame;                // initial frame of the process being entered
+
+/* Devices */
+static timer_t systick_timer;                   // POSIX timer standing in for SysTick
+static bool systick_made = FALSE;
+static FILE *uart_out = NULL;
+
+/* Slot in the register file for a target address */
+static unsigned long *reg(unsigned long addr) {
+    for (int i = 0; i < nregs; i++)
+        if (regaddr[i] == addr)
+            return &regval[i];
+    if (nregs == HOST_REGS) {
+        fprintf(stderr, "hostport: register file full at 0x%08lX\n", addr);
+        exit(1);
+    }
+    regaddr[nregs] = addr;
+    regval[nregs] = 0;
+    return &regval[nregs++];
+}
+
+/* Nanoseconds on the monotonic clock */
+static unsigned long long host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Cycles of the simulated core clock as a timespec */
+static struct timespec cycles_ts(unsigned long long cycles) {
+    struct timespec ts;
+    unsigned long long ns = cycles * 1000000000ULL / HOST_CLOCK_HZ;
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    return ts;
+}
+
+/**************************************************
+ *          EXCEPTIONS (SVC, SysTick, PendSV)
+ *************************************************/
+
+/* Take pending SysTicks then PendSV, as the core does on leaving an
+ * exception, and return to thread mode. Entered with in_handler set */
+static void exception_tail(void) {
+    while (ticks_pending > 0 && !irq_masked) {
+        __sync_fetch_and_sub(&ticks_pending, 1);
+        SysTickHandler();
+    }
+    if (started && (*reg(HOST_NVIC_INT_CTRL) & TRIGGER_PENDSV)) {
+        *reg(HOST_NVIC_INT_CTRL) &= ~TRIGGER_PENDSV;
+        PendSVHandler();
+    }
+    in_handler = 0;
+}
+
+/* SysTick: taken at once from thread mode, otherwise left pending until the
+ * running exception ends or interrupts are enabled again */
+static void systick_signal(int sig) {
+    st_counted = 1;
+    __sync_fetch_and_add(&ticks_pending, 1);
+    if (in_handler || irq_masked || !started)
+        return;
+    in_handler = 1;
+    exception_tail();
+}
+
+/* Supervisor call from main() (starts the first process) */
+void host_svc(void) {
+    stack_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.r12 = NUM_KCALLS;
+    in_handler = 1;
+    SVCHandler(&frame);
+    exception_tail();
+}
+
+/* Kernel call: SVCHandler() gets a frame holding the arguments in r0-r3 and
+ * the code in r12, as stacked on the target, and returns through its r0. The
+ * frame is on the caller's stack, so a blocked receive can be completed in it */
+extern "C" int kcall(unsigned long arg1, unsigned long arg2, unsigned long arg3, unsigned long arg4, unsigned int code) {
+    stack_frame frame;
+    frame.r0 = arg1;
+    frame.r1 = arg2;
+    frame.r2 = arg3;
+    frame.r3 = arg4;
+    frame.r12 = code;
+    in_handler = 1;
+    if (SVCHandler(&frame))                     // slow path: switch before pending SysTicks
+        PendSVHandler();
+    exception_tail();
+    return (int) frame.r0;
+}
+
+/* cpsid i */
+void host_irq_disable(void) {
+    irq_masked = 1;
+}
+
+/* cpsie i: a SysTick that came in meanwhile is taken now (in thread mode) */
+void host_irq_enable(void) {
+    irq_masked = 0;
+    if (!in_handler && started && ticks_pending > 0) {
+        in_handler = 1;
+        exception_tail();
+    }
+}
+
+/* Sleep until the next signal (SysTick) */
+void host_wfi(void) {
+    pause();
+}
+
+/**************************************************
+ *                  REGISTERS
+ *************************************************/
+
+/* (Re)arm the SysTick timer from ST_CTRL and ST_RELOAD. 'restart' reloads the
+ * count (write to ST_CURRENT or enable); otherwise a new reload value only
+ * applies from the next wrap, as on the target */
+static void systick_program(bool restart) {
+    struct itimerspec its;
+    unsigned long ctrl = *reg(HOST_ST_CTRL);
+    memset(&its, 0, sizeof(its));
+    if (!systick_made) {
+        struct sigaction sa;
+        struct sigevent sev;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = systick_signal;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGALRM, &sa, NULL);
+        memset(&sev, 0, sizeof(sev));
+        sev.sigev_notify = SIGEV_SIGNAL;
+        sev.sigev_signo = SIGALRM;
+        timer_create(CLOCK_MONOTONIC, &sev, &systick_timer);
+        systick_made = TRUE;
+    }
+    if ((ctrl & ST_CTRL_ENABLE) && (ctrl & ST_CTRL_INTEN)) {
+        its.it_interval = cycles_ts((unsigned long long) *reg(HOST_ST_RELOAD) + 1);
+        its.it_value = its.it_interval;
+        if (!restart) {
+            struct itimerspec now;
+            timer_gettime(systick_timer, &now);
+            if (now.it_value.tv_sec != 0 || now.it_value.tv_nsec != 0)
+                its.it_value = now.it_value;
+        }
+    }
+    timer_settime(systick_timer, 0, &its, NULL);
+}
+
+/* Read a simulated register */
+unsigned long host_read(unsigned long addr) {
+    switch (addr) {
+        case HOST_ST_CURRENT: {                 // cycles left in the current period
+            struct itimerspec now;
+            if (!systick_made)
+                return 0;
+            timer_gettime(systick_timer, &now);
+            return (unsigned long)(((unsigned long long) now.it_value.tv_sec * 1000000000ULL
+                    + now.it_value.tv_nsec) * HOST_CLOCK_HZ / 1000000000ULL);
+        }
+        case HOST_ST_CTRL: {                    // COUNTFLAG clears on read
+            unsigned long ctrl = *reg(addr) | (st_counted ? ST_CTRL_COUNT : 0);
+            st_counted = 0;
+            return ctrl;
+        }
+        case HOST_DWT_CYCCNT:                   // 32 bit cycle counter
+            return (unsigned int)(host_ns() * HOST_CLOCK_HZ / 1000000000ULL);
+        case HOST_UART0_FR:                     // TX FIFO never full
+        case HOST_UART0_MIS:                    // no UART interrupts
+            return 0;
+        default:
+            return *reg(addr);
+    }
+}
+
+/* Write a simulated register */
+void host_write(unsigned long addr, unsigned long val) {
+    switch (addr) {
+        case HOST_NVIC_INT_CTRL:                // set / clear pending PendSV
+            if (val & CLEAR_PENDST)             // drop a pending SysTick
+                ticks_pending = 0;
+            if (val & CLEAR_PENDSV)
+                *reg(addr) &= ~TRIGGER_PENDSV;
+            else
+                *reg(addr) |= val & TRIGGER_PENDSV;
+            break;
+        case HOST_ST_CTRL:
+            *reg(addr) = val & ~ST_CTRL_COUNT;  // COUNTFLAG is read only
+            systick_program(TRUE);
+            break;
+        case HOST_ST_RELOAD:
+            *reg(addr) = val;
+            systick_program(FALSE);
+            break;
+        case HOST_ST_CURRENT:                   // any write clears the count (and COUNTFLAG)
+            st_counted = 0;
+            systick_program(TRUE);
+            break;
+        case HOST_UART0_DR:
+            if (uart_out == NULL) {
+                const char *name = getenv("HOST_UART");
+                uart_out = fopen(name != NULL ? name : HOST_UART_FILE, "wb");
+                if (uart_out == NULL)
+                    uart_out = stderr;
+            }
+            fputc((int)(val & 0xFF), uart_out);
+            break;
+        default:
+            *reg(addr) = val;
+            break;
+    }
+}
+
+/**************************************************
+ *                  PROCESSES
+ *************************************************/
+
+/* Take a context for a process that is about to run for the first time */
+static ucontext_t *ctx_alloc(void) {
+    if (nctxfree < 0) {
+        nctxfree = 0;
+        for (int i = PCB_POOL_SIZE - 1; i >= 0; i--)
+            ctxfree[nctxfree++] = &ctxpool[i];
+    }
+    return ctxfree[--nctxfree];                 // never empty: one context per PCB
+}
+
+/* Return the context of a terminated process */
+static void ctx_free(ucontext_t *ctx) {
+    ctxfree[nctxfree++] = ctx;
+}
+
+/* 'sp' is a context (rather than the initial frame of a new process) */
+static bool is_ctx(unsigned long sp) {
+    return sp >= (unsigned long) ctxpool && sp < (unsigned long)(ctxpool + PCB_POOL_SIZE);
+}
+
+/* First instructions of every process: leave the exception that switched to
+ * it, then run the entry point from its initial frame. Returning goes to the
+ * frame's LR (PTerminateProcess()) just as on the target */
+static void host_entry(void) {
+    stack_frame *frame = entry_frame;
+    exception_tail();
+    ((void (*)(void)) frame->pc)();
+    ((void (*)(void)) frame->lr)();
+}
+
+/* PSP and MSP */
+unsigned long get_PSP(void) {
+    return host_psp;
+}
+
+unsigned long get_MSP(void) {
+    return 0;
+}
+
+void set_PSP(volatile unsigned long ProcessStack) {
+    host_psp = ProcessStack;
+}
+
+void set_MSP(volatile unsigned long MainStack) {
+}
+
+unsigned long get_SP() {
+    return 0;
+}
+
+/* Note the context being switched out (r4-r11 are saved by swapcontext()) */
+void save_registers() {
+    host_from = host_psp;
+    from_dead = running->terminated;
+}
+
+/* Switch to the context next_process() chose. A process running for the
+ * first time gets a context on its pool stack, below its initial frame */
+void restore_registers() {
+    ucontext_t *to;
+    if (host_psp == host_from)
+        return;
+    if (is_ctx(host_psp)) {
+        to = (ucontext_t *) host_psp;
+    } else {
+        to = ctx_alloc();
+        getcontext(to);
+        to->uc_stack.ss_sp = running->stack;
+        to->uc_stack.ss_size = host_psp - (unsigned long) running->stack;
+        to->uc_link = NULL;
+        sigemptyset(&to->uc_sigmask);
+        makecontext(to, host_entry, 0);
+        entry_frame = (stack_frame *) host_psp;
+        host_psp = (unsigned long) to;
+    }
+    if (from_dead) {                            // nothing to come back to
+        ctx_free((ucontext_t *) host_from);
+        setcontext(to);
+    }
+    swapcontext((ucontext_t *) host_from, to);
+}
+
+/* Enter the first process, leaving main() for good */
+void start_process(unsigned long sp) {
+    started = TRUE;
+    host_from = (unsigned long) &main_ctx;
+    from_dead = FALSE;
+    host_psp = sp;
+    restore_registers();
+}
@@ -0,0 +1,46 @@
+/*
+ * File: hostport.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Linux simulator port of the kernel (selected by HOST_SIM, see
+ *          port.h). Memory mapped registers become hostreg objects whose
+ *          reads and writes are routed to a simulated register file, so the
+ *          SysTick, NVIC, DWT and UART0 accesses in the kernel sources work
+ *          unchanged: SysTick is driven by a POSIX timer, PendSV is run on
+ *          exit from simulated exceptions, DWT_CYCCNT counts nanoseconds and
+ *          UART0 output is written to a file.
+ *          Processes run in ucontexts on the stacks from the stack pools.
+ *          Interrupt disable and the exception priorities (SVC and SysTick
+ *          equal, PendSV lowest) are modelled by deferring the SysTick signal.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+unsigned long host_read(unsigned long addr);            // read a simulated register
+void host_write(unsigned long addr, unsigned long val); // write a simulated register
+
+/* A memory mapped register of the simulated TM4C1294 */
+class hostreg {
+private:
+    unsigned long addr;                 // address of the register on the target
+public:
+    hostreg(unsigned long a) : addr(a) {}
+    operator unsigned long() const { return host_read(addr); }
+    hostreg &operator=(unsigned long v) { host_write(addr, v); return *this; }
+    hostreg &operator|=(unsigned long v) { host_write(addr, host_read(addr) | v); return *this; }
+    hostreg &operator&=(unsigned long v) { host_write(addr, host_read(addr) & v); return *this; }
+};
+
+void host_irq_disable(void);            // hold off SysTick (cpsid i)
+void host_irq_enable(void);             // let SysTick in again, taking any that are pending (cpsie i)
+void host_svc(void);                    // supervisor call from main(): SVCHandler() then pending SysTick/PendSV
+void host_wfi(void);                    // wait for the next interrupt
+
+#define HWREG(addr)     hostreg(addr)   // memory mapped register
+#define GIntDisable()   host_irq_disable()
+#define GIntEnable()    host_irq_enable()
+#define SVC()           host_svc()
+#define WFI()           host_wfi()
+
+#define HOST_CLOCK_HZ   1000000000UL    // simulated core clock: one cycle per nanosecond
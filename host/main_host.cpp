@@ -0,0 +1,168 @@
+/*
+ * File: main_host.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Hosted (Linux) counterpart of main.cpp. Starts the kernel exactly
+ *          as the target does and runs kernel path benchmarks as processes:
+ *          kernel call round trip, message ping-pong between two processes,
+ *          and many senders feeding one receiver. Times come from
+ *          DWT_CYCCNT, which counts nanoseconds in the simulator. The LOW
+ *          reporter runs once every benchmark has finished, prints the
+ *          results and ends the simulation.
+ *          Run as "kernelsim suite" it registers the target's benchmark
+ *          suite (bench.cpp) instead; its results go to the UART output.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "globals.h"
+#include "systick.h"
+#include "process.h"
+#include "kernel.h"
+#include "scheduler.h"
+#include "pools.h"
+#include "trace.h"
+#include "bench.h"
+
+#define BENCH_CALLS         100000      // GETID kernel calls
+#define BENCH_ROUNDTRIPS    20000       // ping-pong round trips
+#define BENCH_SENDERS       1000        // processes sending to the fan-in receiver
+#define BENCH_MESSAGES      10          // messages sent by each of them
+#define PING_QUEUE          1           // queue of the ping-pong client
+#define PONG_QUEUE          2           // queue of the ping-pong server
+#define FANIN_QUEUE         3           // queue of the fan-in receiver
+
+/* Result of one benchmark */
+struct benchresult {
+    const char *name;                   // what was timed
+    unsigned long count;                // operations timed
+    unsigned long cycles;               // cycles (ns) they took in total
+};
+
+static benchresult results[] = {
+    {"GETID kernel call", 0, 0},
+    {"send/receive round trip", 0, 0},
+    {"fan-in message", 0, 0},
+};
+
+/* Cycles since 'start' (DWT_CYCCNT is 32 bits) */
+static unsigned long since(unsigned long start) {
+    return (unsigned int)(CYCLES() - start);
+}
+
+/* Kernel call round trip */
+static void bench_getid(void) {
+    unsigned long start = CYCLES();
+    for (int i = 0; i < BENCH_CALLS; i++)
+        PGetPID();
+    results[0].cycles = since(start);
+    results[0].count = BENCH_CALLS;
+}
+
+/* Ping-pong client: send, then block until the server answers */
+static void bench_ping(void) {
+    char msg[8] = "PING";
+    unsigned int my_queue = PBind(PING_QUEUE);
+    unsigned long start = CYCLES();
+    for (int i = 0; i < BENCH_ROUNDTRIPS; i++) {
+        PSendMessage(PONG_QUEUE, msg, sizeof(msg));
+        PReceiveMessage(my_queue, msg, sizeof(msg));
+    }
+    results[1].cycles = since(start);
+    results[1].count = BENCH_ROUNDTRIPS;
+}
+
+/* Ping-pong server: answer every message */
+static void bench_pong(void) {
+    char msg[8];
+    unsigned int my_queue = PBind(PONG_QUEUE);
+    for (int i = 0; i < BENCH_ROUNDTRIPS; i++) {
+        PReceiveMessage(my_queue, msg, sizeof(msg));
+        PSendMessage(PING_QUEUE, msg, sizeof(msg));
+    }
+}
+
+/* Fan-in receiver: outranks the senders, so every send wakes and preempts it */
+static void bench_collector(void) {
+    char msg[8];
+    unsigned int my_queue = PBind(FANIN_QUEUE);
+    unsigned long start = CYCLES();
+    for (int i = 0; i < BENCH_SENDERS * BENCH_MESSAGES; i++)
+        PReceiveMessage(my_queue, msg, sizeof(msg));
+    results[2].cycles = since(start);
+    results[2].count = BENCH_SENDERS * BENCH_MESSAGES;
+}
+
+/* Fan-in sender */
+static void bench_sender(void) {
+    char msg[8] = "DATA";
+    for (int i = 0; i < BENCH_MESSAGES; i++)
+        PSendMessage(FANIN_QUEUE, msg, sizeof(msg));
+}
+
+/* Print the results and end the simulation */
+static void bench_report(void) {
+    printf("%-26s %10s %12s\n", "benchmark", "count", "ns/op");
+    for (unsigned i = 0; i < sizeof(results) / sizeof(results[0]); i++)
+        printf("%-26s %10lu %12.1f\n", results[i].name, results[i].count,
+               results[i].count ? (double) results[i].cycles / results[i].count : 0.0);
+    printf("processes registered: %d, ticks: %u, message containers high water: %lu\n",
+           next_pid, ticks, msgpool_stats.high_water);
+    printf("trace records: %lu, dropped: %lu\n", trace_stats.recorded, trace_stats.dropped);
+    procstats stats;                            // processes still registered
+    printf("%-5s %14s %10s %8s %12s\n", "pid", "cpu (ns)", "switches", "stack", "stack used");
+    for (int pid = 0; pid < next_pid; pid++)
+        if (PProcStats(pid, &stats) == SUCCESS)
+            printf("%-5d %14llu %10lu %8lu %12lu\n", pid, stats.run_cycles,
+                   stats.switches, stats.stack_size, stats.stack_used);
+    exit(0);
+}
+
+/* Ends the simulation once the benchmark suite has finished. Runs whenever
+ * the benchmarks are all blocked or sleeping, so checks every few ticks */
+static void suite_done(void) {
+    while (!bench_finished())
+        PSleep(10);
+    exit(0);
+}
+
+int main(int argc, char *argv[]) {
+
+    /* Initialize SYSTICK */
+    SysTickPeriod(MAX_WAIT);                    // Set SysTick Period
+    SysTickIntEnable();                         // Enable SysTick Interrupts
+
+    /* Initialize Kernel */
+    KernelInit();                               // Initialize Kernel
+
+    /* Register the benchmarks; each priority level finishes before the next runs */
+    reg_proc(idle_process, next_pid, IDLE, STACK_SMALL);
+    if (argc > 1 && strcmp(argv[1], "suite") == 0) {
+        bench_register();
+        reg_proc(suite_done, next_pid, IDLE + 1);
+    }
+    else {
+        reg_proc(bench_getid, next_pid, HIGHEST);
+        reg_proc(bench_pong, next_pid, HIGH);
+        reg_proc(bench_ping, next_pid, HIGH);
+        reg_proc(bench_collector, next_pid, MEDIUM + 1);
+        for (int i = 0; i < BENCH_SENDERS; i++)
+            if (reg_proc(bench_sender, next_pid, MEDIUM) != SUCCESS) {
+                fprintf(stderr, "out of PCBs or stacks after %d senders\n", i);
+                return 1;
+            }
+        reg_proc(bench_report, next_pid, LOW);
+    }
+
+    /* Set First Running Process */
+    running = ready_front();
+
+    /* Enable Interrupts */
+    GIntEnable();
+
+    /* Main Program Execution */
+    SVC();
+    return 0;
+}
@@ -1,14 +1,37 @@
-/*
- * File: kernel.cpp
- * Author: Stephen Sampson
- * Original Date: October 2nd 2017
- * Revised Date: December 5th 2017
- * Purpose: Performs kernel initialization
- */
-
-#include "kernel.h"
-
-/* Ensure PendSV priority is set to lowest (7) */
-void KernelInit() {
-    NVIC_SYS_PRI3_R |= PENDSV_LOWEST_PRIORITY;
-}
+/*
+ * File: kernel.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Defines the kernel's global structures and performs kernel initialization
+ */
+
+#include "kernel.h"
+#include "globals.h"
+#include "pools.h"
+#include "timer.h"
+
+/* Create queues of size specified in globals.h */
+u_queue UART0_TX_BUFFER(UART0_BUFF_SZ);
+p_queue procqueue[NUM_PROC_QUEUES];
+m_queue msgqueue[MAX_MSG_QUEUES];
+t_queue timerwheel[TIMER_WHEEL_SLOTS];
+
+/* Pointer PCB of running process */
+pcb* running;
+
+/* Global Variables */
+unsigned long ready_bitmap = 0;
+int next_pid = 0;
+unsigned int ticks = 0;
+bool force_psp = TRUE;
+
+/* Ensure PendSV priority is set to lowest (7), start the cycle counter and
+ * build the PCB and stack pools (must precede the first reg_proc()) */
+void KernelInit() {
+    PoolInit();
+    NVIC_SYS_PRI3_R |= PENDSV_LOWEST_PRIORITY;
+    DEMCR_R |= DEMCR_TRCENA;
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= DWT_CYCCNTENA;
+}
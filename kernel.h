@@ -1,19 +1,29 @@
-/*
- * File: kernel.h
- * Author: Stephen Sampson
- * Original Date: October 2nd 2017
- * Revised Date: December 5th 2017
- * Purpose: Set the priority of PENDSV and define kernel initialization
- *          function.
- */
-
-#pragma once                            // ensure file is included only once in compilation
-
-/* location of register containing PendSV prority */
-#define NVIC_SYS_PRI3_R (*((volatile unsigned long *) 0xE000ED20))
-
-/* define lowest priority as 7 as per page 179 in data sheet */
-#define PENDSV_LOWEST_PRIORITY 0x00E00000
-
-/* kernel init */
-void KernelInit(void);
+/*
+ * File: kernel.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Set the priority of PENDSV and define kernel initialization
+ *          function.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "port.h"                       // HWREG() (memory mapped registers)
+
+/* location of register containing PendSV prority */
+#define NVIC_SYS_PRI3_R HWREG(0xE000ED20)
+
+/* define lowest priority as 7 as per page 179 in data sheet */
+#define PENDSV_LOWEST_PRIORITY 0x00E00000
+
+/* Data Watchpoint and Trace (DWT) cycle counter, used to time kernel paths */
+#define DEMCR_R         HWREG(0xE000EDFC)  // Debug Exception and Monitor Control
+#define DWT_CTRL_R      HWREG(0xE0001000)  // DWT Control
+#define DWT_CYCCNT_R    HWREG(0xE0001004)  // DWT Cycle Count
+#define DEMCR_TRCENA    0x01000000      // enable DWT and ITM
+#define DWT_CYCCNTENA   0x00000001      // enable the cycle counter
+#define CYCLES()        DWT_CYCCNT_R    // current cycle count (wraps every 2^32 cycles)
+
+/* kernel init */
+void KernelInit(void);
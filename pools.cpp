@@ -0,0 +1,165 @@
+/*
+ * File: pools.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: See pools.h. Free PCBs and message containers are linked through
+ *          their 'next' field and free stacks through their first word, so the pools need no storage
+ *          beyond the objects themselves.
+ */
+
+#include "globals.h"
+#include "pools.h"
+
+/* PCB pool */
+static pcb pcbpool[PCB_POOL_SIZE];
+static pcb *pcbfree = NULL;
+
+/* Message container slab */
+static msgcontainer msgpool[MSG_POOL_SIZE];
+static msgcontainer *msgfree = NULL;
+poolstats msgpool_stats;
+
+/* Stack pools (one per class) */
+static unsigned long stacksmall[STACK_SMALL_COUNT][STACK_SMALL_SIZE];
+static unsigned long stackdefault[STACK_DEFAULT_COUNT][STACK_DEFAULT_SIZE];
+static unsigned long stacklarge[STACK_LARGE_COUNT][STACK_LARGE_SIZE];
+static unsigned long *stackfree[NUM_STACK_CLASSES];
+
+/* Size (in words) of the stacks in each class */
+static const unsigned long stacksizes[NUM_STACK_CLASSES] = {STACK_SMALL_SIZE, STACK_DEFAULT_SIZE, STACK_LARGE_SIZE};
+
+/* Thread every PCB and stack onto the free list of its pool */
+void PoolInit(void) {
+    pcbfree = NULL;
+    for (int i = PCB_POOL_SIZE - 1; i >= 0; i--) {
+        pcbpool[i].next = pcbfree;
+        pcbfree = &pcbpool[i];
+    }
+    msgfree = NULL;
+    for (int i = MSG_POOL_SIZE - 1; i >= 0; i--) {
+        msgpool[i].next = msgfree;
+        msgfree = &msgpool[i];
+    }
+    msgpool_stats.in_use = 0;
+    msgpool_stats.high_water = 0;
+    msgpool_stats.failures = 0;
+    for (int i = 0; i < NUM_STACK_CLASSES; i++)
+        stackfree[i] = NULL;
+    for (int i = STACK_SMALL_COUNT - 1; i >= 0; i--)
+        stack_free(stacksmall[i], STACK_SMALL);
+    for (int i = STACK_DEFAULT_COUNT - 1; i >= 0; i--)
+        stack_free(stackdefault[i], STACK_DEFAULT);
+    for (int i = STACK_LARGE_COUNT - 1; i >= 0; i--)
+        stack_free(stacklarge[i], STACK_LARGE);
+}
+
+/* Take a PCB from the pool and reset it to a newly constructed state */
+pcb *pcb_alloc(void) {
+    pcb *ptr = pcbfree;
+    if (ptr == NULL)                    // every PCB in use
+        return NULL;
+    pcbfree = ptr->next;
+    *ptr = pcb();
+    return ptr;
+}
+
+/* Return a PCB and the stack it owns to their pools */
+void pcb_free(pcb *ptr) {
+    if (ptr->stack != NULL)
+        stack_free(ptr->stack, ptr->stackclass);
+    ptr->stack = NULL;
+    ptr->next = pcbfree;
+    pcbfree = ptr;
+}
+
+/* Take a stack of the given class (its first word links the free list) */
+unsigned long *stack_alloc(unsigned stackclass) {
+    unsigned long *stack;
+    if (stackclass >= NUM_STACK_CLASSES)
+        return NULL;
+    stack = stackfree[stackclass];
+    if (stack != NULL)
+        stackfree[stackclass] = (unsigned long *) stack[0];
+    return stack;
+}
+
+/* Return a stack to the free list of its class */
+void stack_free(unsigned long *stack, unsigned stackclass) {
+    stack[0] = (unsigned long) stackfree[stackclass];
+    stackfree[stackclass] = stack;
+}
+
+/* Size (in words) of the stacks in a class */
+unsigned long stack_words(unsigned stackclass) {
+    return stacksizes[stackclass];
+}
+
+/* Fill 'words' words of a stack, from its base, with STACK_PAINT */
+void stack_paint(unsigned long *stack, unsigned long words) {
+    for (unsigned long i = 0; i < words; i++)
+        stack[i] = STACK_PAINT;
+}
+
+/* Stacks grow down from the top, so the words still painted at the base were
+ * never used. The high water mark is everything above the lowest overwritten word */
+unsigned long stack_high_water(const pcb *ptr) {
+    unsigned long words = stack_words(ptr->stackclass);
+    unsigned long i = 0;
+    while (i < words && ptr->stack[i] == STACK_PAINT)
+        i++;
+    return (words - i) * sizeof(unsigned long);
+}
+
+/* Search the pool for a registered (and not terminated) PCB with the given PID */
+pcb *pcb_find(unsigned long pid) {
+    for (int i = 0; i < PCB_POOL_SIZE; i++)
+        if (pcbpool[i].stack != NULL && !pcbpool[i].terminated && pcbpool[i].pid == pid)
+            return &pcbpool[i];
+    return NULL;
+}
+
+/* Next registered (and not terminated) PCB in the pool after 'ptr' (the first if NULL) */
+pcb *pcb_next(pcb *ptr) {
+    for (int i = (ptr == NULL) ? 0 : ptr - pcbpool + 1; i < PCB_POOL_SIZE; i++)
+        if (pcbpool[i].stack != NULL && !pcbpool[i].terminated)
+            return &pcbpool[i];
+    return NULL;
+}
+
+/* Index of a PCB in the pool (names a rendezvous client to its server) */
+unsigned int pcb_index(const pcb *ptr) {
+    return ptr - pcbpool;
+}
+
+/* Registered (and not terminated) PCB at an index of the pool (NULL if none) */
+pcb *pcb_at(unsigned long index) {
+    if (index >= PCB_POOL_SIZE || pcbpool[index].stack == NULL || pcbpool[index].terminated)
+        return NULL;
+    return &pcbpool[index];
+}
+
+/* Take a message container from the slab and reset it */
+msgcontainer *msg_alloc(void) {
+    msgcontainer *ptr = msgfree;
+    if (ptr == NULL) {                  // every container in use
+        msgpool_stats.failures++;
+        return NULL;
+    }
+    msgfree = ptr->next;
+    ptr->next = NULL;                   // reset the header only, copying a whole
+    ptr->prev = NULL;                   // container would also copy its body
+    ptr->size = 0;
+    ptr->msg = NULL;
+    ptr->loan = FALSE;
+    if (++msgpool_stats.in_use > msgpool_stats.high_water)
+        msgpool_stats.high_water = msgpool_stats.in_use;
+    return ptr;
+}
+
+/* Return a message container to the slab */
+void msg_free(msgcontainer *ptr) {
+    ptr->next = msgfree;
+    msgfree = ptr;
+    msgpool_stats.in_use--;
+}
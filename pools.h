@@ -0,0 +1,71 @@
+/*
+ * File: pools.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Statically sized pools of process control blocks, process
+ *          stacks and message containers. Each pool is a fixed array threaded onto a free list so
+ *          allocating and freeing are O(1) and never touch the heap, making
+ *          process registration time independent of heap state.
+ *          Stacks come in classes of different sizes; the number of stacks in
+ *          each class and their size (in words) is set below.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "queues.h"                     // pcb object type
+
+/* Pool dimensions (may be overridden per deployment, e.g. by the hosted build) */
+#ifndef PCB_POOL_SIZE
+#define PCB_POOL_SIZE       16          // max number of processes registered at once
+#endif
+#ifndef MSG_POOL_SIZE
+#define MSG_POOL_SIZE       64          // max number of messages queued at once (across all queues)
+#endif
+
+/* Stack classes (size in words, number available) */
+enum stackclasses {STACK_SMALL, STACK_DEFAULT, STACK_LARGE, NUM_STACK_CLASSES};
+#ifndef STACK_SMALL_SIZE
+#define STACK_SMALL_SIZE    256         // 1 KB stacks for shallow processes (e.g. idle)
+#endif
+#ifndef STACK_SMALL_COUNT
+#define STACK_SMALL_COUNT   4
+#endif
+#ifndef STACK_DEFAULT_SIZE
+#define STACK_DEFAULT_SIZE  1024        // 4 KB stacks
+#endif
+#ifndef STACK_DEFAULT_COUNT
+#define STACK_DEFAULT_COUNT 12
+#endif
+#ifndef STACK_LARGE_SIZE
+#define STACK_LARGE_SIZE    2048        // 8 KB stacks for deep call chains
+#endif
+#ifndef STACK_LARGE_COUNT
+#define STACK_LARGE_COUNT   2
+#endif
+
+#define STACK_PAINT         0xC5C5C5C5  // stacks are filled with this at registration to find their high water mark
+
+/* Message container pool usage, for sizing MSG_POOL_SIZE per deployment */
+struct poolstats {
+    unsigned long in_use;               // containers currently allocated
+    unsigned long high_water;           // most containers ever allocated at once
+    unsigned long failures;             // allocations refused because the pool was empty
+};
+
+extern poolstats msgpool_stats;         // message container pool usage (defined in pools.cpp)
+
+void PoolInit(void);                            // thread every pool onto its free list
+pcb *pcb_alloc(void);                           // take a PCB from the pool (NULL if exhausted)
+void pcb_free(pcb *ptr);                        // return a PCB and its stack to their pools
+unsigned long *stack_alloc(unsigned stackclass);// take a stack of the given class (NULL if exhausted)
+void stack_free(unsigned long *stack, unsigned stackclass); // return a stack to its class
+unsigned long stack_words(unsigned stackclass); // size (in words) of stacks in a class
+void stack_paint(unsigned long *stack, unsigned long words);        // fill a stack with STACK_PAINT
+unsigned long stack_high_water(const pcb *ptr); // most of a process's stack ever used (bytes)
+pcb *pcb_find(unsigned long pid);               // registered PCB with the given PID (NULL if none)
+pcb *pcb_next(pcb *ptr);                        // next registered PCB after 'ptr', NULL starts (and ends) a scan
+unsigned int pcb_index(const pcb *ptr);         // index of a PCB in the pool
+pcb *pcb_at(unsigned long index);               // registered PCB at an index of the pool (NULL if none)
+msgcontainer *msg_alloc(void);                  // take a message container from the slab (NULL if exhausted)
+void msg_free(msgcontainer *ptr);               // return a message container to the slab
@@ -0,0 +1,23 @@
+/*
+ * File: port.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Processor specific primitives used by the portable kernel code.
+ *          The TM4C1294 build uses the Cortex-M4 instructions and memory
+ *          mapped registers directly; building with HOST_SIM set swaps in
+ *          the Linux simulator (host/hostport.h) so the kernel sources
+ *          compile unchanged for host testing and benchmarking.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#if HOST_SIM
+#include "host/hostport.h"              // ucontext / POSIX timer backend
+#else
+#define HWREG(addr)     (*((volatile unsigned long *)(addr)))   // memory mapped register
+#define GIntDisable()   __asm(" cpsid i")   // Global interrupt disable
+#define GIntEnable()    __asm(" cpsie i")   // Global interrupt enable
+#define SVC()           __asm(" SVC #0")    // macro for SVC as it can not be called directly
+#define WFI()           __asm(" WFI")       // macro for WFI (sleep until the next interrupt)
+#endif
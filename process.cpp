@@ -1,252 +1,397 @@
-/*
- * File: process.cpp
-*  Original Source: http://lh.ece.dal.ca/eced4402/
- * Modified By: Stephen Sampson and Mason Butler
- * Revised Date: December 5th 2017
- * Purpose: Provides function definitions for registering,
- *          running, and swapping processes including the saving and
- *          restoring of process state.
- */
-
-#include <string>
-#include "process.h"
-#include "globals.h"
-#include "uart.h"
-#include "systick.h"
-#include "KernelCalls.h"
-#include "message.h"
-
-/* Definition for table declared in globals.h */
-std::string priorities[] = {"IDLE", "LOW", "MEDIUM", "HIGH", "HIGHEST"};
-
-/* Returns contents of PSP (current process stack */
-unsigned long get_PSP(void) {
-    __asm(" mrs     r0, psp");
-    __asm(" bx  lr");
-    return 0;
-}
-
-/* Returns contents of MSP (main stack) */
-unsigned long get_MSP(void) {
-    __asm(" mrs     r0, msp");
-    __asm(" bx  lr");
-    return 0;
-}
-
-/* set PSP to ProcessStack */
-void set_PSP(volatile unsigned long ProcessStack) {
-    __asm(" msr psp, r0");
-}
-
-/* Set MSP to MainStack */
-void set_MSP(volatile unsigned long MainStack) {
-    __asm(" msr msp, r0");
-}
-
-/* Save r4..r11 on process stack */
-void save_registers() {
-    __asm(" mrs     r0,psp");
-    __asm(" stmdb   r0!,{r4-r11}");
-    __asm(" msr psp,r0");
-}
-
-/* Restore r4..r11 from stack to CPU */
-void restore_registers() {
-    __asm(" mrs r0,psp");
-    __asm(" ldmia   r0!,{r4-r11}");
-    __asm(" msr psp,r0");
-}
-
-/* Get stack pointer */
-unsigned long get_SP() {
-    __asm("     mov     r0,SP");
-    __asm(" bx  lr");
-    return 0;
-}
-
-
-
-
-/* Assign 'data' to R7 */
-void assignR7(volatile unsigned long data) {
-    __asm(" mov r7,r0");
-}
-
-/* Swap running process for next in queue */
-void next_process(void) {
-    running -> sp = get_PSP();              // save current stack pointer
-    running = running->next;                // Set running process to next in queue
-    set_PSP(running -> sp);                 // Set PSP
-    uartformat *processprint = &FormatTable[running->pid];  // find appropriate entry in print format table
-    UART0_printf(processprint->cursor);     // update cursor position in console
-}
-
-/* Register a new instance of a process with a specified priority and unique PID */
-int reg_proc(void (*func_name)(), unsigned pid, unsigned priority) {
-    int *stack = new int [STACKSIZE];       // Create Unique Process Stack
-      if(stack == NULL)                     // If stack does not point to a valid address
-          return ERROR;                     // Stack creation failed, return error
-
-    pcb *temp = new pcb;                    // Create PCB for Process
-    temp->pid = pid;                        // set PID field in PCB
-    temp->sp = (unsigned long)stack + STACKSIZE - (sizeof(stack_frame));
-    temp->priority = priority;              // Set Priority field in PCB
-    if(priority >= highest_p)               // If this process is of higher priority than those already registered
-        highest_p = priority;               // Update which queue contains highest priority process
-
-    /* create a new stack frame for this process and initialize its registers */
-    stack_frame *stack_init = (struct stack_frame*)temp->sp;
-    stack_init->r0 = 0x00000000;
-    stack_init->r1 = 0x11111111;
-    stack_init->r2 = 0x22222222;
-    stack_init->r3 = 0x33333333;
-    stack_init->r4 = 0x44444444;
-    stack_init->r5 = 0x55555555;
-    stack_init->r6 = 0x66666666;
-    stack_init->r7 = 0x77777777;
-    stack_init->r8 = 0x88888888;
-    stack_init->r9 = 0x99999999;
-    stack_init->r10 = 0x10101010;
-    stack_init->r11 = 0x11011011;
-    stack_init->r12 = 0x12121212;
-    stack_init->psr = 0x01000000;
-    stack_init->pc = (unsigned long)func_name;
-    stack_init->lr = (unsigned long)PTerminateProcess;
-
-    procqueue[priority].enqueue(temp);      // Enqueue newly created process to proper queue
-    uartformat *processprint = &FormatTable[pid];                           // find appropriate entry in print format table
-    UART0_printf(processprint->reg.append(priorities[priority]));           // print diagnostic info to console
-    next_pid++;                             // Increment value of next PID available to be registered
-    return SUCCESS;                         // Process registered successfully
-}
-
-/* Dummy Process 1 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process1(void){
-    unsigned int my_queue = PBind(running->pid);    // process call to kernel to bind to message queue
-    char *txt = "FOR P9";                   // define message to be sent
-    msgcontainer *rmsg;                     // create container for message
-    _Delay(10);                             // delay X number of systick interrupts
-    PSendMessage(9, txt, 6);                // process call to kernel to send message
-    _Delay(10);                             // delay X number of systick interrupts
-    PReceiveMessage(my_queue, rmsg, 6);     // process call to kernel to receive message
-}
-
-
-
-
-
-
-/* Dummy Process 2 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process2(void){
-    unsigned int my_queue = PBind(running->pid);    // process call to kernel to bind to message queue
-    msgcontainer *rmsg;                     // create container for message
-    PReceiveMessage(my_queue, rmsg, 6);     // process call to kernel to receive message
-}
-
-/* Dummy Process 3 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process3(void){
-    char *txt = "FOR ??";                   // define message to be sent
-    _Delay(30);                             // delay 30 systick interrupts
-    PSendMessage(3, txt, 6);                // process call to kernel to send message
-
-}
-
-/* Dummy Process 4 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process4(void){
-    char *txt = "FOR ??";                   // define message to be sent
-    _Delay(30);                             // delay 30 systick interrupts
-    PSendMessage(3, txt, 6);                // process call to kernel to send message
-}
-
-/* Dummy Process 5 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process5(void){
-    char *txt = "FOR ??";                   // define message to be sent
-    _Delay(30);                             // delay 30 systick interrupts
-    PSendMessage(3, txt, 6);                // process call to kernel to send message
-}
-
-/* Dummy Process 6 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process6(void){
-    char *txt = "FOR ??";                   // define message to be sent
-    _Delay(30);                             // delay 30 systick interrupts
-    PSendMessage(3, txt, 6);                // process call to kernel to send message
-}
-
-/* Dummy Process 7 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process7(void){
-    char *txt = "FOR ??";                   // define message to be sent
-    _Delay(100);                            // delay 100 systick interrupts
-    PSendMessage(3, txt, 6);                // process call to kernel to send message
-}
-
-/* Dummy Process 8 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process8(void){
-    char *txt = "FOR ??";                   // define message to be sent
-    _Delay(80);                             // delay 80 systick interrupts
-    PSendMessage(3, txt, 6);                // process call to kernel to send message
-}
-
-/* Dummy Process 9 - Modified for various tests. This example is for 'comprehensive' test */
-void dummy_process9(void){
-    unsigned int my_queue = PBind(running->pid);    // process call to kernel to bind to message queue
-    char *txt = "FOR P1";                   // define message to be sent
-    msgcontainer *rmsg;                     // create container for message
-    _Delay(10);                             // delay 10 systick interrupts
-    PSendMessage(1, txt, 6);                // process call to kernel to send message
-    _Delay(10);                             // delay 10 systick interrupts
-    PReceiveMessage(my_queue, rmsg, 6);     // process call to kernel to receive message
-}
-
-/* Idle Process. CPU must be doing 'something'. Effectively a busy wait */
-void idle_process(void){
-    while(1);
-}
-
-
-
-/**********************************************************************************************************
- *                           Mason Butler authored the functions below
- *********************************************************************************************************/
-
-/* Process call to kernel to perform specified function with given arguments (if applicable) */
-int pkCall(unsigned int code, void *arg){
-    volatile struct kcallargs args;         // create an argument structure to be passed to kernel
-    args.code = code;                       // set code of kcallargs to that specified in pkCall
-    args.arg1 = (unsigned int) arg;         // set arg1 of kcallargs to that specified in pkCall
-    assignR7((unsigned long)&args);         // assign arg structure to R7 to be used by kernerl
-    SVC();                                  // make a call to SVC
-    return args.rtnvalue;                   // return value put into arg.rtnvalue by kernel
-}
-
-/* Process call to kernel to terminate process */
-void PTerminateProcess(void){
-    pkCall(TERMINATE, NULL);                // value returned from process kernel call with specified code/arg(s)
-}
-
-/* Process call to kernel to get PID of process */
-unsigned int PGetPID(){
-    return pkCall(GETID, NULL);             // value returned from process kernel call with specified code/arg(s)
-}
-
-/* Process call to kernel to bind to message queue */
-signed int PBind(unsigned int queue_num){
-    return pkCall(BIND, (void *) queue_num);// return value returned from process kernel call with specified code/arg(s)
-}
-
-/* Process call to kernel to send message given parameters */
-signed int PSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize){
-    volatile struct p_msg pmsg;             // create message structure to store message to be sent
-    pmsg.queueID = destQueueID;             // set the destination queue field of message struct
-    pmsg.msg = message;                     // set the message field of message struct
-    pmsg.msg_size = msgSize;                // set the message size fieled of message struct
-    return pkCall(SEND, (void *)&pmsg);     // value returned from process kernel call with specified code/arg(s)
-}
-
-/* Process call to kernel to receive messaged given parameters */
-signed int PReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize){
-    volatile struct p_msg pmsg;             // create message structure to store message to be received
-    pmsg.queueID = queueID;                 // queue to receive message from
-    pmsg.msg = message;                     // space to store the message to be received
-    pmsg.msg_size = msgSize;                // size of the message we expect to receive
-    return pkCall(RECEIVE, (void *) &pmsg); // value returned from process kernel call with specified code/arg(s)
-}
+/*
+ * File: process.cpp
+*  Original Source: http://lh.ece.dal.ca/eced4402/
+ * Modified By: Stephen Sampson and Mason Butler
+ * Revised Date: December 5th 2017
+ * Purpose: Provides function definitions for registering,
+ *          running, and swapping processes including the saving and
+ *          restoring of process state.
+ */
+
+#include <string>
+#include "process.h"
+#include "globals.h"
+#include "uart.h"
+#include "systick.h"
+#include "KernelCalls.h"
+#include "scheduler.h"
+#include "kernel.h"
+#include "trace.h"
+
+/* Definition for table declared in globals.h */
+std::string priorities[] = {"IDLE", "LOW", "MEDIUM", "HIGH", "HIGHEST"};
+
+/* Results of the wake latency test */
+latencystats wake_latency = {0, 0xFFFFFFFF, 0, 0};
+volatile unsigned long latency_stamp;       // cycle count taken by latency_sender() just before sending
+
+/* Swap running process for the process at the front of the highest priority ready queue */
+void next_process(void) {
+    unsigned long prev = running->pid;      // outgoing process (for the trace)
+    GIntDisable();                          // SysTick may not change the ready set or 'ticks' mid switch
+    unsigned long now = CYCLES();
+    running->run_cycles += (unsigned int)(now - running->dispatched);  // charge the outgoing process for its run
+#if TICKLESS_IDLE
+    TicklessExit();                         // correct 'ticks' if an idle sleep was cut short
+#endif
+    if (running->terminated)                // nothing to save: return PCB and stack to their pools
+        pcb_free(running);
+    else {
+        running -> sp = get_PSP();          // save current stack pointer
+        if (running->is_ready())            // preempted: waiting again from now (aging)
+            running->ready_since = ticks;
+        else if (running->aged)             // aged process blocked or slept: drop what aging gave it
+            ready_unage(running);
+    }
+    running = ready_front();                // Set running process to front of highest priority queue
+    set_PSP(running -> sp);                 // Set PSP
+    running->dispatched = now;              // start charging the incoming process
+    running->switches++;
+    if (running->job_state == JOB_RELEASED) {   // first run of a periodic job: record its release jitter
+        unsigned long jitter = (unsigned int)(now - running->release_stamp);
+        edfstats *stats = &running->edf_stats;
+        stats->releases++;
+        stats->jitter_total += jitter;
+        if (jitter < stats->jitter_min)
+            stats->jitter_min = jitter;
+        if (jitter > stats->jitter_max)
+            stats->jitter_max = jitter;
+        running->job_state = JOB_STARTED;
+    }
+#if TICKLESS_IDLE
+    if (ready_bitmap == PRIORITY_BIT(IDLE)) // only idle can run: sleep until the next timed wakeup
+        TicklessEnter();
+#endif
+    trace(TR_SWITCH, running->pid, prev);   // record the event (before SysTick may record again)
+    GIntEnable();
+    KPRINT(running->pid, FormatTable[running->pid].cursor); // update cursor position in console
+}
+
+/* Build the PCB and stack of a new process (not yet ready to run) */
+PRIVATE pcb *proc_create(void (*func_name)(), unsigned pid, unsigned priority, unsigned stackclass, unsigned quantum) {
+    unsigned long *stack = stack_alloc(stackclass); // Take Unique Process Stack from pool
+      if(stack == NULL)                     // If no stack of this class is free
+          return NULL;                      // Stack creation failed, return error
+
+    pcb *temp = pcb_alloc();                // Take PCB for Process from pool
+    if(temp == NULL) {                      // If every PCB is in use
+        stack_free(stack, stackclass);      // give the stack back
+        return NULL;                        // PCB creation failed, return error
+    }
+    temp->stack = stack;                    // PCB owns the stack (freed with it)
+    temp->stackclass = stackclass;
+    temp->pid = pid;                        // set PID field in PCB
+    temp->sp = (unsigned long)(stack + stack_words(stackclass)) - sizeof(stack_frame);
+    temp->priority = priority;              // Set Priority field in PCB
+    temp->base_priority = priority;
+    temp->quantum = quantum;                // Set round-robin quantum (ticks)
+    stack_paint(stack, stack_words(stackclass));    // paint the stack so its high water mark can be found
+
+    /* create a new stack frame for this process and initialize its registers */
+    stack_frame *stack_init = (struct stack_frame*)temp->sp;
+    stack_init->r0 = 0x00000000;
+    stack_init->r1 = 0x11111111;
+    stack_init->r2 = 0x22222222;
+    stack_init->r3 = 0x33333333;
+    stack_init->r4 = 0x44444444;
+    stack_init->r5 = 0x55555555;
+    stack_init->r6 = 0x66666666;
+    stack_init->r7 = 0x77777777;
+    stack_init->r8 = 0x88888888;
+    stack_init->r9 = 0x99999999;
+    stack_init->r10 = 0x10101010;
+    stack_init->r11 = 0x11011011;
+    stack_init->r12 = 0x12121212;
+    stack_init->psr = 0x01000000;
+    stack_init->pc = (unsigned long)func_name;
+    stack_init->lr = (unsigned long)PTerminateProcess;
+    return temp;
+}
+
+/* Make a newly created process ready to run */
+PRIVATE void proc_admit(pcb *temp) {
+    ready_enqueue(temp);                    // Enqueue newly created process to proper queue
+    trace(TR_REGISTER, temp->pid, temp->priority);  // record the event
+    KPRINT(temp->pid, FormatTable[temp->pid].reg + priorities[PRIORITY_BAND(temp->priority)]); // print diagnostic info to console
+    next_pid++;                             // Increment value of next PID available to be registered
+}
+
+/* Register a new instance of a process with a specified priority and unique PID */
+int reg_proc(void (*func_name)(), unsigned pid, unsigned priority, unsigned stackclass, unsigned quantum) {
+    if(quantum == 0 || priority == EDF_PRIORITY)    // must run for at least a tick; EDF level is reserved
+        return ERROR;
+    pcb *temp = proc_create(func_name, pid, priority, stackclass, quantum);
+    if(temp == NULL)                        // out of stacks or PCBs
+        return ERROR;
+    proc_admit(temp);
+    return SUCCESS;                         // Process registered successfully
+}
+
+/* Register a periodic process in the EDF class. Its first job is released
+ * now; each call to PWaitNextPeriod() ends a job and waits for the next
+ * release, 'period' ticks after the last. A job is due 'deadline' ticks after
+ * its release */
+int reg_edf(void (*func_name)(), unsigned pid, unsigned period, unsigned deadline, unsigned stackclass) {
+    if(period == 0 || deadline == 0 || deadline > period)
+        return ERROR;
+    pcb *temp = proc_create(func_name, pid, EDF_PRIORITY, stackclass, QUANTUM_DEFAULT);
+    if(temp == NULL)                        // out of stacks or PCBs
+        return ERROR;
+    temp->edf = TRUE;
+    temp->period = period;
+    temp->rel_deadline = deadline;
+    temp->release = ticks;
+    temp->abs_deadline = ticks + deadline;
+    proc_admit(temp);
+    return SUCCESS;
+}
+
+/* Give a registered process a CPU budget: once it has run for 'budget' ticks
+ * in the current period it is taken off the ready queues until the period
+ * ends (see SysTickHandler()). Call before the kernel starts or with
+ * interrupts disabled */
+int set_budget(unsigned long pid, unsigned int budget, unsigned int period) {
+    pcb *pcb_ptr = pcb_find(pid);
+    if(pcb_ptr == NULL || (budget != 0 && (period == 0 || budget > period)))
+        return ERROR;
+    pcb_ptr->budget = budget;
+    pcb_ptr->budget_period = period;
+    pcb_ptr->budget_used = 0;
+    pcb_ptr->period_start = ticks;
+    return SUCCESS;
+}
+
+/* Dummy Process 1 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process1(void){
+    unsigned int my_queue = PBind(running->pid);    // process call to kernel to bind to message queue
+    char *txt = "FOR P9";                   // define message to be sent
+    char rmsg[6];                           // space for message
+    PSleep(10);                             // sleep X number of systick interrupts
+    PSendMessage(9, txt, 6);                // process call to kernel to send message
+    PSleep(10);                             // sleep X number of systick interrupts
+    PReceiveMessage(my_queue, rmsg, 6);     // process call to kernel to receive message
+}
+
+
+
+
+
+
+/* Dummy Process 2 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process2(void){
+    unsigned int my_queue = PBind(running->pid);    // process call to kernel to bind to message queue
+    char rmsg[6];                           // space for message
+    PReceiveMessage(my_queue, rmsg, 6);     // process call to kernel to receive message
+}
+
+/* Dummy Process 3 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process3(void){
+    char *txt = "FOR ??";                   // define message to be sent
+    PSleep(30);                             // sleep 30 systick interrupts
+    PSendMessage(3, txt, 6);                // process call to kernel to send message
+
+}
+
+/* Dummy Process 4 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process4(void){
+    char *txt = "FOR ??";                   // define message to be sent
+    PSleep(30);                             // sleep 30 systick interrupts
+    PSendMessage(3, txt, 6);                // process call to kernel to send message
+}
+
+/* Dummy Process 5 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process5(void){
+    char *txt = "FOR ??";                   // define message to be sent
+    PSleep(30);                             // sleep 30 systick interrupts
+    PSendMessage(3, txt, 6);                // process call to kernel to send message
+}
+
+/* Dummy Process 6 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process6(void){
+    char *txt = "FOR ??";                   // define message to be sent
+    PSleep(30);                             // sleep 30 systick interrupts
+    PSendMessage(3, txt, 6);                // process call to kernel to send message
+}
+
+/* Dummy Process 7 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process7(void){
+    char *txt = "FOR ??";                   // define message to be sent
+    PSleep(100);                            // sleep 100 systick interrupts
+    PSendMessage(3, txt, 6);                // process call to kernel to send message
+}
+
+/* Dummy Process 8 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process8(void){
+    char *txt = "FOR ??";                   // define message to be sent
+    PSleep(80);                             // sleep 80 systick interrupts
+    PSendMessage(3, txt, 6);                // process call to kernel to send message
+}
+
+/* Dummy Process 9 - Modified for various tests. This example is for 'comprehensive' test */
+void dummy_process9(void){
+    unsigned int my_queue = PBind(running->pid);    // process call to kernel to bind to message queue
+    char *txt = "FOR P1";                   // define message to be sent
+    char rmsg[6];                           // space for message
+    PSleep(10);                             // sleep 10 systick interrupts
+    PSendMessage(1, txt, 6);                // process call to kernel to send message
+    PSleep(10);                             // sleep 10 systick interrupts
+    PReceiveMessage(my_queue, rmsg, 6);     // process call to kernel to receive message
+}
+
+/* Latency test sender (LOW). Stamps the cycle counter, sends to the blocked
+ * receiver, then keeps the CPU busy. With WAKE_PREEMPTION the receiver runs on
+ * exit from the send; without it the receiver waits until the sender gives up
+ * the CPU (sleeps or its quantum expires) */
+void latency_sender(void){
+    char *txt = "PING";                     // define message to be sent
+    for (int i = 0; i < LATENCY_SAMPLES; i++) {
+        PSleep(1);                          // let the receiver block again
+        latency_stamp = CYCLES();           // time of send
+        PSendMessage(LATENCY_QUEUE, txt, 4);// wakes the receiver
+        for (volatile int w = 0; w < LATENCY_WORK; w++) {}  // background work at LOW priority
+    }
+}
+
+/* Latency test receiver (HIGHEST). Blocks on its queue and records the cycles
+ * from the sender's stamp until it is running again */
+void latency_receiver(void){
+    unsigned int my_queue = PBind(LATENCY_QUEUE);   // process call to kernel to bind to message queue
+    char rmsg[4];                           // space for message
+    for (int i = 0; i < LATENCY_SAMPLES; i++) {
+        PReceiveMessage(my_queue, rmsg, 4); // queue is empty: blocks until the sender's message is delivered
+        unsigned long latency = CYCLES() - latency_stamp;
+        wake_latency.samples++;
+        wake_latency.total += latency;
+        if (latency < wake_latency.min)
+            wake_latency.min = latency;
+        if (latency > wake_latency.max)
+            wake_latency.max = latency;
+    }
+    UART0_printf("\033[20;1HWAKE LATENCY (cycles) MIN: ");
+    UART0_printnum(wake_latency.min);
+    UART0_printf(" MEAN: ");
+    UART0_printnum(wake_latency.total / wake_latency.samples);
+    UART0_printf(" MAX: ");
+    UART0_printnum(wake_latency.max);
+}
+
+/* Idle Process. Ships recorded trace events over UART0, then sleeps until the
+ * next interrupt; with tickless idle SysTick is stretched by next_process()
+ * so that interrupt is the next timed wakeup */
+void idle_process(void){
+    while(1) {
+#if TRACE_ENABLE
+        trace_drain();
+#endif
+        WFI();
+    }
+}
+
+
+
+/**********************************************************************************************************
+ *                           Mason Butler authored the functions below
+ *********************************************************************************************************/
+
+/* Process call to kernel to terminate process */
+void PTerminateProcess(void){
+    pkCall(TERMINATE);                      // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to get PID of process */
+unsigned int PGetPID(){
+    return pkCall(GETID);                   // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to sleep for a number of ticks without using the CPU */
+signed int PSleep(unsigned int sleep_ticks){
+    return pkCall(SLEEP, sleep_ticks);      // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to end the current job of a periodic (EDF) process
+ * and wait for its next release */
+signed int PWaitNextPeriod(void){
+    return pkCall(WAITPERIOD);              // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to give up the rest of the quantum */
+signed int PYield(void){
+    return pkCall(YIELD);                   // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to get the CPU and stack usage of a process */
+signed int PProcStats(unsigned long pid, procstats *stats){
+    stats->pid = pid;                       // process to report on
+    return pkCall(STATS, (unsigned long) stats); // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to find out what every process that is not ready is
+ * waiting for. Returns the number waiting (entries past 'max' are not filled) */
+signed int PWaitReport(waitinfo *list, unsigned int max){
+    return pkCall(WAITREPORT, (unsigned long) list, max);  // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to get the occupancy statistics of a message queue */
+signed int PQueueStats(unsigned int queue_num, queuestats *stats){
+    return pkCall(QUEUESTATS, queue_num, (unsigned long) stats);    // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to bind to message queue */
+signed int PBind(unsigned int queue_num, unsigned int mode, unsigned int capacity){
+    return pkCall(BIND, queue_num, mode, capacity); // return value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to designate the sender of a queue owned by the caller */
+signed int PDesignateSender(unsigned int queue_num, unsigned long pid){
+    return pkCall(DESIGNATE, queue_num, pid);   // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to send message given parameters. With MSG_LOAN the
+ * buffer itself is handed to the receiver and must not be touched again. A
+ * SEND_BLOCK send to a full queue returns once a receive has made space */
+signed int PSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize, unsigned int mode, unsigned int full,
+                        unsigned int priority){
+    return pkCall(SEND, destQueueID, (unsigned long) message, msgSize,
+                  mode | (full << MSG_MODE_BITS) | (priority << MSG_PRIO_SHIFT));   // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to receive messaged given parameters. Returns the
+ * number of bytes received (at most msgSize unless loaned), TIMEOUT or ERROR */
+signed int PReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout){
+    if(timeout > WAIT_FOREVER)              // longest timeout that fits beside the mode
+        timeout = WAIT_FOREVER;
+    return pkCall(RECEIVE, queueID, (unsigned long) message, msgSize, mode | (timeout << MSG_MODE_BITS));  // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to receive from whichever queue of a set has a message
+ * first. Returns ANY_QUEUE()/ANY_BYTES() of the message, TIMEOUT or ERROR */
+signed int PReceiveAny(unsigned long queues, void *message, unsigned int msgSize, unsigned int mode, unsigned int timeout){
+    if(timeout > WAIT_FOREVER)              // longest timeout that fits beside the mode
+        timeout = WAIT_FOREVER;
+    return pkCall(RECEIVEANY, queues, (unsigned long) message, msgSize, mode | (timeout << MSG_MODE_BITS));    // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel for a rendezvous with the owner of a queue: blocks
+ * until the owner has received 'request' and replied. Returns the reply size */
+signed int PSendReceive(unsigned int queueID, void *request, unsigned int reqSize, void *reply, unsigned int replySize){
+    if(reqSize >> RDV_SIZE_BITS != 0 || replySize >> RDV_SIZE_BITS != 0)    // sizes share one argument
+        return ERROR;
+    return pkCall(SENDRECEIVE, queueID, (unsigned long) request, reqSize | (replySize << RDV_SIZE_BITS),
+                  (unsigned long) reply);   // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to wait for a rendezvous request. Returns the number
+ * of bytes received (at most reqSize) with the client to reply to in *client */
+signed int PReceiveRequest(unsigned int queueID, void *request, unsigned int reqSize, unsigned long *client){
+    return pkCall(RECEIVEREQUEST, queueID, (unsigned long) request, reqSize, (unsigned long) client);   // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to reply to a rendezvous client, releasing it */
+signed int PReply(unsigned long client, void *reply, unsigned int replySize){
+    return pkCall(REPLY, client, (unsigned long) reply, replySize);    // value returned from process kernel call with specified code/arg(s)
+}
+
+/* Process call to kernel to receive a message only if one is already queued */
+signed int PTryReceive(unsigned int queueID, void *message, unsigned int msgSize, unsigned int mode){
+    return PReceiveMessage(queueID, message, msgSize, mode, 0);
+}
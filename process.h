@@ -1,81 +1,144 @@
-/*
- * File: process.h
-*  Original Source: http://lh.ece.dal.ca/eced4402/
- * Modified By: Stephen Sampson and Mason Butler
- * Revised Date: December 5th 2017
- * Purpose: Contains definitions, structures, macros, and functions applicable to processes
- *          including but not limited to the ability to save/restore process state, perform
- *          context switches and IPC operations such as bind, send and receive.
- *          Requires access to process, message, and UART queues.
- */
-
-#pragma once                            // ensure file is included only once in compilation
-
-#include "queues.h"                     // allow access to process, message, and UART queue(s)
-
-#define PRIVATE static                  // allow use of PRIVATE keyword in place of static
-#define SVC()       __asm(" SVC #0")    // macro for SVC as it can not be called directly
-#define STACKSIZE   1024                // size to be reserved for each process stack
-
-/* Cortex default stack frame */
-struct stack_frame {
-    /* Must be stacked by software (if desired) */
-    unsigned long r4;                   // general purpose register
-    unsigned long r5;                   // general purpose register
-    unsigned long r6;                   // general purpose register
-    unsigned long r7;                   // general purpose register
-    unsigned long r8;                   // general purpose register
-    unsigned long r9;                   // general purpose register
-    unsigned long r10;                  // general purpose register
-    unsigned long r11;                  // general purpose register
-    /* Stacked by hardware (implicit)*/
-    unsigned long r0;                   // general purpose register + args
-    unsigned long r1;                   // general purpose register + args
-    unsigned long r2;                   // general purpose register + args
-    unsigned long r3;                   // general purpose register + args
-    unsigned long r12;                  //
-    unsigned long lr;                   // link register (contains return address)
-    unsigned long pc;                   // program counrer (entry point / execution location)
-    unsigned long psr;                  // xPSR, process stack register
-};
-
-/* Prototypes for provided functions */
-void set_LR(volatile unsigned long);        // set link register (return address / mode + stack)
-void set_PSP(volatile unsigned long);       // set process stack pointer
-void set_MSP(volatile unsigned long);       // set main stack pointer
-void assignR7(volatile unsigned long data); // use R7 to pass address of arg structure to kernel
-void save_registers();                      // save R4->R11 on process stack
-void restore_registers();                   // restore R4->R11 from process stack to CPU
-unsigned long get_PSP();                    // return contents of current process stack
-unsigned long get_MSP(void);                // return contents of main stack
-unsigned long get_SP();                     // return location of stack pointer
-
-/* Prototypes for added functions */
-int reg_proc(void (*func_name)(), unsigned pid, unsigned priority); // register and place process in proper queue
-void PTerminateProcess(void);               // process call to kernel to terminate process
-void next_process(void);                    // get the next waiting to run process (called from PendSVHandler())
-void idle_process(void);                    // idle_process (infinite loop, never ends)
-void dummy_process1(void);                  // dummy process (for testing)
-void dummy_process2(void);                  // dummy process (for testing)
-void dummy_process3(void);                  // dummy process (for testing)
-void dummy_process4(void);                  // dummy process (for testing)
-void dummy_process5(void);                  // dummy process (for testing)
-void dummy_process6(void);                  // dummy process (for testing)
-void dummy_process7(void);                  // dummy process (for testing)
-void dummy_process8(void);                  // dummy process (for testing)
-void dummy_process9(void);                  // dummy process (for testing)
-
-
-
-
-/**********************************************************************************************************
- *                           Mason Butler authored the functions below
- *********************************************************************************************************/
-
-int pkCall(unsigned int code, void *arg);   // process call to kernel with code + args (if applicable)
-unsigned int PGetPID();                     // process call to kernel to get PID
-signed int PBind(unsigned int queue_num);   // process call to kernel to bind process to msgqueue
-/* process call to kernel to send message to a specified message queue */
-signed int PSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize);
-/* process call to kernel to receive message from queue owned by process (ownership set on bind()) */
-signed int PReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize);
+/*
+ * File: process.h
+*  Original Source: http://lh.ece.dal.ca/eced4402/
+ * Modified By: Stephen Sampson and Mason Butler
+ * Revised Date: December 5th 2017
+ * Purpose: Contains definitions, structures, macros, and functions applicable to processes
+ *          including but not limited to the ability to save/restore process state, perform
+ *          context switches and IPC operations such as bind, send and receive.
+ *          Requires access to process, message, and UART queues.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "queues.h"                     // allow access to process, message, and UART queue(s)
+#include "pools.h"                      // PCB and stack pools
+
+#include "port.h"                       // SVC() and WFI()
+
+#define PRIVATE static                  // allow use of PRIVATE keyword in place of static
+#define QUANTUM_DEFAULT 1               // round-robin quantum (ticks) of a process unless given to reg_proc()
+
+/* Wake latency test (see latency_receiver() in process.cpp) */
+#define LATENCY_TEST    FALSE           // register the latency test instead of the dummy processes
+#define LATENCY_QUEUE   15              // message queue the latency receiver binds to
+#define LATENCY_SAMPLES 100             // number of send -> receiver running samples
+#define LATENCY_WORK    20000           // busy loop iterations the sender runs after each send
+
+/* Send to receiver running latency (in cycles) gathered by the latency test */
+struct latencystats {
+    unsigned long samples;              // samples taken
+    unsigned long min;                  // shortest latency
+    unsigned long max;                  // longest latency
+    unsigned long total;                // sum of latencies (for mean)
+};
+
+/* Cortex default stack frame */
+struct stack_frame {
+    /* Must be stacked by software (if desired) */
+    unsigned long r4;                   // general purpose register
+    unsigned long r5;                   // general purpose register
+    unsigned long r6;                   // general purpose register
+    unsigned long r7;                   // general purpose register
+    unsigned long r8;                   // general purpose register
+    unsigned long r9;                   // general purpose register
+    unsigned long r10;                  // general purpose register
+    unsigned long r11;                  // general purpose register
+    /* Stacked by hardware (implicit)*/
+    unsigned long r0;                   // general purpose register + args
+    unsigned long r1;                   // general purpose register + args
+    unsigned long r2;                   // general purpose register + args
+    unsigned long r3;                   // general purpose register + args
+    unsigned long r12;                  //
+    unsigned long lr;                   // link register (contains return address)
+    unsigned long pc;                   // program counrer (entry point / execution location)
+    unsigned long psr;                  // xPSR, process stack register
+};
+
+/* Prototypes for provided functions */
+void set_LR(volatile unsigned long);        // set link register (return address / mode + stack)
+void set_PSP(volatile unsigned long);       // set process stack pointer
+void set_MSP(volatile unsigned long);       // set main stack pointer
+void save_registers();                      // save R4->R11 on process stack
+void restore_registers();                   // restore R4->R11 from process stack to CPU
+unsigned long get_PSP();                    // return contents of current process stack
+unsigned long get_MSP(void);                // return contents of main stack
+unsigned long get_SP();                     // return location of stack pointer
+void start_process(unsigned long sp);       // enter the first process on its stack (does not return)
+
+/* Prototypes for added functions */
+/* register and place process in proper queue, taking its stack from the given stack class (see pools.h) */
+/* and giving it a round-robin quantum of the given number of ticks */
+int reg_proc(void (*func_name)(), unsigned pid, unsigned priority, unsigned stackclass = STACK_DEFAULT,
+             unsigned quantum = QUANTUM_DEFAULT);
+/* register a periodic process in the EDF class with a period and relative deadline (ticks) */
+int reg_edf(void (*func_name)(), unsigned pid, unsigned period, unsigned deadline, unsigned stackclass = STACK_DEFAULT);
+/* limit a registered process to 'budget' ticks of CPU in every 'period' ticks (budget 0 = unlimited) */
+int set_budget(unsigned long pid, unsigned int budget, unsigned int period);
+void PTerminateProcess(void);               // process call to kernel to terminate process
+void next_process(void);                    // get the next waiting to run process (called from PendSVHandler())
+void idle_process(void);                    // idle_process (sleeps until interrupted, never ends)
+void dummy_process1(void);                  // dummy process (for testing)
+void dummy_process2(void);                  // dummy process (for testing)
+void dummy_process3(void);                  // dummy process (for testing)
+void dummy_process4(void);                  // dummy process (for testing)
+void dummy_process5(void);                  // dummy process (for testing)
+void dummy_process6(void);                  // dummy process (for testing)
+void dummy_process7(void);                  // dummy process (for testing)
+void dummy_process8(void);                  // dummy process (for testing)
+void dummy_process9(void);                  // dummy process (for testing)
+void latency_sender(void);                  // latency test: LOW priority sender
+void latency_receiver(void);                // latency test: HIGHEST priority receiver
+
+
+
+
+/**********************************************************************************************************
+ *                           Mason Butler authored the functions below
+ *********************************************************************************************************/
+
+/* Supervisor call with code in r12 and arguments in r0-r3, returning the kernel's r0 (cortexm4.cpp) */
+extern "C" int kcall(unsigned long arg1, unsigned long arg2, unsigned long arg3, unsigned long arg4, unsigned int code);
+/* process call to kernel with code + args (if applicable) */
+inline int pkCall(unsigned int code, unsigned long arg1 = 0, unsigned long arg2 = 0, unsigned long arg3 = 0, unsigned long arg4 = 0) {
+    return kcall(arg1, arg2, arg3, arg4, code);
+}
+unsigned int PGetPID();                     // process call to kernel to get PID
+signed int PSleep(unsigned int sleep_ticks);// process call to kernel to sleep for a number of ticks
+signed int PYield(void);                    // process call to kernel to give the CPU to the next process of the same priority
+signed int PWaitNextPeriod(void);           // process call to kernel to end the job of an EDF process and wait for its next release
+/* process call to kernel to bind process to msgqueue (BIND_SHARED: as one of a pool of receivers),
+ * holding at most 'capacity' messages (0: unbounded) */
+signed int PBind(unsigned int queue_num, unsigned int mode = BIND_EXCLUSIVE, unsigned int capacity = 0);
+/* process call to kernel to name the process expected to send to a queue the caller owns (priority inheritance) */
+signed int PDesignateSender(unsigned int queue_num, unsigned long pid);
+signed int PProcStats(unsigned long pid, procstats *stats);    // process call to kernel to get CPU and stack usage of a process
+/* process call to kernel to list what each waiting process waits for (at most 'max' entries, returns how many wait) */
+signed int PWaitReport(waitinfo *list, unsigned int max);
+/* process call to kernel to get the capacity, depth and high water mark of a message queue */
+signed int PQueueStats(unsigned int queue_num, queuestats *stats);
+/* process call to kernel to send message to a specified message queue (copied, or loaned with MSG_LOAN).
+ * 'full' chooses what happens when the queue is at capacity: SEND_BLOCK, SEND_FAIL or SEND_OVERWRITE (which
+ * returns QUEUE_FULL rather than drop a message of higher priority than its own).
+ * Messages of a higher 'priority' (msgpriorities) are received ahead of those already queued */
+signed int PSendMessage(unsigned int destQueueID, void *message, unsigned int msgSize, unsigned int mode = MSG_COPY,
+                        unsigned int full = SEND_BLOCK, unsigned int priority = MSG_NORMAL);
+/* process call to kernel to receive message from queue owned by process (ownership set on bind()).
+ * Returns the number of bytes received, or TIMEOUT if none arrives within 'timeout' ticks.
+ * With MSG_LOAN 'message' is a void ** set to the loaned buffer */
+signed int PReceiveMessage(unsigned int queueID, void *message, unsigned int msgSize, unsigned int mode = MSG_COPY,
+                           unsigned int timeout = WAIT_FOREVER);
+/* process call to kernel to send a request to the owner of a queue and wait for its reply (rendezvous, no queueing).
+ * Returns the size of the reply copied into 'reply' */
+signed int PSendReceive(unsigned int queueID, void *request, unsigned int reqSize, void *reply, unsigned int replySize);
+/* process call to kernel to receive the next request sent to a queue owned by the process with PSendReceive().
+ * Returns its size; '*client' names the client to PReply() to */
+signed int PReceiveRequest(unsigned int queueID, void *request, unsigned int reqSize, unsigned long *client);
+/* process call to kernel to reply to a client received with PReceiveRequest() */
+signed int PReply(unsigned long client, void *reply, unsigned int replySize);
+/* process call to kernel to receive a message without blocking (WOULD_BLOCK if the queue is empty) */
+signed int PTryReceive(unsigned int queueID, void *message, unsigned int msgSize, unsigned int mode = MSG_COPY);
+/* process call to kernel to receive from any of a set of queues owned by the process (QUEUE_BIT() of each).
+ * Returns the queue the message came from and its size, read with ANY_QUEUE() and ANY_BYTES() */
+signed int PReceiveAny(unsigned long queues, void *message, unsigned int msgSize, unsigned int mode = MSG_COPY,
+                       unsigned int timeout = WAIT_FOREVER);
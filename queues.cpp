@@ -1,247 +1,372 @@
-/*
- * File: queues.cpp
- * Author: Stephen Sampson
- * Original Date: September 23rd 2017 (Expanded A#1 Implementation)
- * Revised Date: December 5th 2017
- * Purpose: See queues.h for detailed explanation. Contains definitions
- *          for member functions of all queues as well as constructors
- *          and destructors for objects stored in these queues.
- */
-
-#include "globals.h"
-#include "queues.h"
-
-/**************************************************
- *                  PROCESSES
- *************************************************/
-
-/* constructor for a new PCB */
-pcb::pcb(void) {
-    sp = NULL;
-    pid = NULL;
-    priority = NULL;
-    next = NULL;
-    prev = NULL;
-    blocked = FALSE;
-}
-
-/* destructor for a PCB freeing any dynamically allocated memory*/
-pcb::~pcb(void) {
-    // Default constructor sufficient.
-    // All message queues bound to PCB are emptied and the
-    // memory allocated to the objects freed in m_queue::clear().
-    // Next, PCB memory is freed by calling p_queue::remove().
-}
-
-/* constructor for a new process queue */
-p_queue::p_queue(void) {
-    front = NULL;
-}
-
-/* destructor for a process queue */
-p_queue::~p_queue(void) {
-    // NEVER CALLED
-    // Process queues are never deleted
-}
-
-/* enqueue PCB to back of queue */
-void p_queue::enqueue(pcb* ptr) {
-    if (front == NULL) {
-        front = ptr;
-        ptr->next = ptr;
-        ptr->prev = ptr;
-    } else {
-        ptr->next = front;
-        ptr->prev = front->prev;
-        front->prev->next = ptr;
-        front->prev = front->prev->next;
-    }
-}
-
-/* get PCB at front of process queue */
-pcb* p_queue::get_front(void) {
-    return front;
-}
-
-
-
-
-
-/* remove PCB from process queue without deleting */
-/* used when moving between queues to avoid copying */
-void p_queue::dequeue(pcb* ptr){
-    if(front->next == NULL){
-        front = NULL;
-    } else {
-        ptr->prev->next = ptr->next;
-        ptr->next->prev = ptr->prev;
-        if(ptr==front)
-            front = front->next;
-    }
-}
-
-/* remove PCB from process queue and free its memory */
-bool p_queue::remove(pcb* ptr) {
-    if (ptr == NULL)
-        return false;
-    if(front->next == front) {
-        front = NULL;
-    } else {
-        ptr->prev->next = ptr->next;
-        ptr->next->prev = ptr->prev;
-        if(ptr == front) {
-            front = front->next;
-        }
-    }
-    delete ptr;
-    return true;
-}
-
-/* return T|F : process queue is empty */
-bool p_queue::empty(void) const {
-    return (front == NULL);
-}
-
-/**************************************************
- *                  MESSAGES
- *************************************************/
-
-/* constructor for a new message container */
-msgcontainer::msgcontainer(void) {
-    size = 0;
-    msg = NULL;
-    next = NULL;
-    prev = NULL;
-}
-
-/* destructor for a message container */
-msgcontainer::~msgcontainer(void) {
-    // links fixed and memory freed in msgcontainer::remove()
-}
-
-/* constructor for a new message queue */
-m_queue::m_queue(void) {
-    front = NULL;
-    owner = NULL;
-}
-
-/* destructor for a message queue */
-m_queue::~m_queue(void) {
-    // NEVER CALLED
-    // Message queues are never deleted
-}
-
-
-
-
-
-/* enqueue message container to back of message queue */
-void m_queue::enqueue(msgcontainer* ptr) {
-    if (front == NULL) {
-        front = ptr;
-        ptr->next = ptr;
-        ptr->prev = ptr;
-    } else {
-        ptr->next = front;
-        ptr->prev = front->prev;
-        front->prev->next = ptr;
-        front->prev = front->prev->next;
-    }
-}
-
-/* get message container at front of message queue */
-msgcontainer* m_queue::get_front(void) {
-    return front;
-}
-
-/* remove messagecontainer from message queue and free its memory */
-bool m_queue::remove(msgcontainer* ptr) {
-    if (ptr == NULL)
-        return false;
-    if(front->next == front) {
-        front = NULL;
-    } else {
-        ptr->prev->next = ptr->next;
-        ptr->next->prev = ptr->prev;
-        if(ptr == front) {
-            front = front->next;
-        }
-    }
-    delete ptr;
-    return true;
-}
-
-/* return T|F : message queue is empty */
-bool m_queue::empty(void) const {
-   return (front == NULL);
-}
-
-/* Clear all entries in message queue freeing memory */
-void m_queue::clear(void) {
-    while(front != NULL){
-        msgcontainer *temp = front;
-        if(front->next == front) {
-            front = NULL;
-        } else {
-            temp->prev->next = temp->next;
-            temp->next->prev = temp->prev;
-            if(temp == front) {
-                front = front->next;
-            }
-        }
-        delete temp;
-    }
-}
-
-
-
-
-
-
-
-
-
-
-
-/******************************************
-*          UART RX and TX Queues
-******************************************/
-
-/* Constructor for a new UART buffer/queue */
-u_queue::u_queue(int sz) : data(new char[sz]) {
-    max = sz;
-    items = 0;
-    insloc = 0;
-    remloc = 0;
-}
-
-/* destructor for a UART buffer/queue freeing any dynamically allocated memory*/
-u_queue::~u_queue(){
-    delete [] data;
-}
-
-/* enqueue character at tail of queue*/
-void u_queue::enqueue(char val) {
-    if(items!=max){
-        data[insloc] = val;
-        items++;
-        insloc++;
-        if(insloc>=(max-1))
-            insloc = 0;
-    }
-}
-
-/* remove character from head of queue and return it */
-char u_queue::dequeue(void) {
-        char temp = data[remloc];
-        items--;
-        remloc++;
-         if(remloc>=(max-1))
-            remloc = 0;
-        return temp;
-}
-
-/* return T|F : queue is empty */
-bool u_queue::empty(void) const {
-    return (items == 0);
-}
+/*
+ * File: queues.cpp
+ * Author: Stephen Sampson
+ * Original Date: September 23rd 2017 (Expanded A#1 Implementation)
+ * Revised Date: December 5th 2017
+ * Purpose: See queues.h for detailed explanation. Contains definitions
+ *          for member functions of all queues as well as constructors
+ *          and destructors for objects stored in these queues.
+ */
+
+#include "globals.h"
+#include "queues.h"
+#include "pools.h"
+#include "scheduler.h"                  // CLZ()
+
+/**************************************************
+ *                  PROCESSES
+ *************************************************/
+
+/* constructor for a new PCB */
+pcb::pcb(void) {
+    sp = NULL;
+    pid = NULL;
+    priority = NULL;
+    base_priority = NULL;
+    inherited = 0;
+    designated = 0;
+    ready_since = 0;
+    aged = 0;
+    next = NULL;
+    prev = NULL;
+    wait_state = WAIT_NONE;
+    sleeping = FALSE;
+    tnext = NULL;
+    tprev = NULL;
+    wake_tick = 0;
+    terminated = FALSE;
+    stack = NULL;
+    stackclass = 0;
+    rcv_buf = NULL;
+    rcv_size = 0;
+    rcv_mode = MSG_COPY;
+    wait_rtn = NULL;
+    rcv_set = 0;
+    rcv_any = FALSE;
+    snd_msg = NULL;
+    snd_size = 0;
+    snd_mode = MSG_COPY;
+    snd_priority = MSG_NORMAL;
+    snd_queue = 0;
+    rcv_client = NULL;
+    waitlist = NULL;
+    bound = 0;
+    run_cycles = 0;
+    switches = 0;
+    dispatched = 0;
+    quantum = 1;
+    slice_left = 1;
+    budget = 0;
+    budget_period = 0;
+    budget_used = 0;
+    period_start = 0;
+    overruns = 0;
+    edf = FALSE;
+    period = 0;
+    rel_deadline = 0;
+    release = 0;
+    abs_deadline = 0;
+    heap_index = 0;
+    job_state = JOB_STARTED;
+    release_stamp = 0;
+    edf_stats.jobs = 0;
+    edf_stats.misses = 0;
+    edf_stats.releases = 0;
+    edf_stats.jitter_min = 0xFFFFFFFF;
+    edf_stats.jitter_max = 0;
+    edf_stats.jitter_total = 0;
+}
+
+/* destructor for a PCB freeing any dynamically allocated memory*/
+pcb::~pcb(void) {
+    // Default constructor sufficient.
+    // All message queues bound to PCB are emptied and the
+    // memory allocated to the objects freed in m_queue::clear().
+    // PCBs and stacks are never deleted, they are returned to their pools by pcb_free().
+}
+
+/* return T|F : process is in a ready queue */
+bool pcb::is_ready(void) const {
+    return wait_state == WAIT_NONE && !terminated;
+}
+
+/* constructor for a new process queue */
+p_queue::p_queue(void) {
+    front = NULL;
+}
+
+/* destructor for a process queue */
+p_queue::~p_queue(void) {
+    // NEVER CALLED
+    // Process queues are never deleted
+}
+
+/* enqueue PCB to back of queue */
+void p_queue::enqueue(pcb* ptr) {
+    if (front == NULL) {
+        front = ptr;
+        ptr->next = ptr;
+        ptr->prev = ptr;
+    } else {
+        ptr->next = front;
+        ptr->prev = front->prev;
+        front->prev->next = ptr;
+        front->prev = front->prev->next;
+    }
+}
+
+/* get PCB at front of process queue */
+pcb* p_queue::get_front(void) {
+    return front;
+}
+
+/* advance front of process queue so the previous front is now at the back */
+void p_queue::rotate(void) {
+    if (front != NULL)
+        front = front->next;
+}
+
+
+
+
+
+/* remove PCB from process queue without deleting */
+/* used when moving between queues to avoid copying */
+void p_queue::dequeue(pcb* ptr){
+    if(front->next == front){
+        front = NULL;
+    } else {
+        ptr->prev->next = ptr->next;
+        ptr->next->prev = ptr->prev;
+        if(ptr==front)
+            front = front->next;
+    }
+}
+
+/* return T|F : process queue is empty */
+bool p_queue::empty(void) const {
+    return (front == NULL);
+}
+
+/* constructor for a new timer queue */
+t_queue::t_queue(void) {
+    front = NULL;
+}
+
+/* destructor for a timer queue */
+t_queue::~t_queue(void) {
+    // NEVER CALLED
+    // Timer queues are never deleted
+}
+
+/* enqueue PCB to back of timer queue */
+void t_queue::enqueue(pcb* ptr) {
+    if (front == NULL) {
+        front = ptr;
+        ptr->tnext = ptr;
+        ptr->tprev = ptr;
+    } else {
+        ptr->tnext = front;
+        ptr->tprev = front->tprev;
+        front->tprev->tnext = ptr;
+        front->tprev = ptr;
+    }
+}
+
+/* remove PCB from timer queue without deleting */
+void t_queue::dequeue(pcb* ptr) {
+    if (ptr->tnext == ptr) {
+        front = NULL;
+    } else {
+        ptr->tprev->tnext = ptr->tnext;
+        ptr->tnext->tprev = ptr->tprev;
+        if (ptr == front)
+            front = ptr->tnext;
+    }
+    ptr->tnext = NULL;
+    ptr->tprev = NULL;
+}
+
+/* get PCB at front of timer queue */
+pcb* t_queue::get_front(void) {
+    return front;
+}
+
+/* return T|F : timer queue is empty */
+bool t_queue::empty(void) const {
+    return (front == NULL);
+}
+
+/**************************************************
+ *                  MESSAGES
+ *************************************************/
+
+/* constructor for a new message container */
+msgcontainer::msgcontainer(void) {
+    size = 0;
+    msg = NULL;
+    loan = FALSE;
+    priority = MSG_NORMAL;
+    next = NULL;
+    prev = NULL;
+    // body is not cleared, only the first 'size' bytes are ever read
+}
+
+/* destructor for a message container */
+msgcontainer::~msgcontainer(void) {
+    // links fixed and container returned to the slab in m_queue::remove()
+}
+
+/* constructor for a new message queue */
+m_queue::m_queue(void) {
+    for (int i = 0; i < MSG_PRIORITIES; i++)
+        front[i] = NULL;
+    levels = 0;
+    owner = NULL;
+    shared = FALSE;
+    members = 0;
+    sender = NULL;
+    stats.capacity = 0;
+    stats.depth = 0;
+    stats.high_water = 0;
+    stats.blocked_sends = 0;
+    stats.failed_sends = 0;
+    stats.overwritten = 0;
+}
+
+/* destructor for a message queue */
+m_queue::~m_queue(void) {
+    // NEVER CALLED
+    // Message queues are never deleted
+}
+
+
+
+
+
+/* enqueue message container to back of the level of its priority */
+void m_queue::enqueue(msgcontainer* ptr) {
+    msgcontainer *&head = front[ptr->priority];
+    if (head == NULL) {
+        head = ptr;
+        ptr->next = ptr;
+        ptr->prev = ptr;
+        levels |= MSG_LEVEL_BIT(ptr->priority);
+    } else {
+        ptr->next = head;
+        ptr->prev = head->prev;
+        head->prev->next = ptr;
+        head->prev = head->prev->next;
+    }
+    if (++stats.depth > stats.high_water)
+        stats.high_water = stats.depth;
+}
+
+/* get message container to deliver next: front of the highest non empty level */
+msgcontainer* m_queue::get_front(void) {
+    if (levels == 0)
+        return NULL;
+    return front[31 - CLZ(levels)];
+}
+
+/* get the oldest message container of the lowest non empty level (the one to
+ * drop when a SEND_OVERWRITE send finds the queue full) */
+msgcontainer* m_queue::get_lowest(void) {
+    if (levels == 0)
+        return NULL;
+    return front[31 - CLZ(levels & (0 - levels))];  // lowest set bit
+}
+
+/* remove message container from message queue and return it to the slab */
+bool m_queue::remove(msgcontainer* ptr) {
+    if (ptr == NULL)
+        return false;
+    msgcontainer *&head = front[ptr->priority];
+    if(head->next == head) {
+        head = NULL;
+        levels &= ~MSG_LEVEL_BIT(ptr->priority);
+    } else {
+        ptr->prev->next = ptr->next;
+        ptr->next->prev = ptr->prev;
+        if(ptr == head) {
+            head = head->next;
+        }
+    }
+    msg_free(ptr);
+    stats.depth--;
+    return true;
+}
+
+/* return T|F : message queue is empty */
+bool m_queue::empty(void) const {
+   return (levels == 0);
+}
+
+/* return T|F : message queue holds its capacity of messages (never if unbounded) */
+bool m_queue::full(void) const {
+   return stats.capacity != 0 && stats.depth >= stats.capacity;
+}
+
+/* Clear all entries in message queue returning them to the slab */
+void m_queue::clear(void) {
+    while(levels != 0)
+        remove(get_front());
+}
+
+
+
+
+
+
+
+
+
+
+
+/******************************************
+*          UART RX and TX Queues
+******************************************/
+
+/* Constructor for a new UART buffer/queue */
+u_queue::u_queue(int sz) : data(new char[sz]) {
+    max = sz;
+    items = 0;
+    insloc = 0;
+    remloc = 0;
+}
+
+/* destructor for a UART buffer/queue freeing any dynamically allocated memory*/
+u_queue::~u_queue(){
+    delete [] data;
+}
+
+/* enqueue character at tail of queue*/
+void u_queue::enqueue(char val) {
+    if(items!=max){
+        data[insloc] = val;
+        items++;
+        insloc++;
+        if(insloc>=(max-1))
+            insloc = 0;
+    }
+}
+
+/* remove character from head of queue and return it */
+char u_queue::dequeue(void) {
+        char temp = data[remloc];
+        items--;
+        remloc++;
+         if(remloc>=(max-1))
+            remloc = 0;
+        return temp;
+}
+
+/* return T|F : queue is empty */
+bool u_queue::empty(void) const {
+    return (items == 0);
+}
+
+/* return number of chars that can still be queued (the last slot is never used) */
+int u_queue::space(void) const {
+    return (max - 1) - items;
+}
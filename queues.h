@@ -1,103 +1,271 @@
-/*
- * File: queues.h
- * Author: Stephen Sampson
- * Original Date: 9/23/2017 (Expanded A#1 Implementation)
- * Revised Date: December 5th 2017
- * Purpose: This file contains the structure of the queue classes used
- *          to create priority process queues, message queues, and
- *          UART0 TX/RX queues.
- *          All queues are circular in nature with UART queues being of
- *          a fixed size (defined in globals.h).
- *          Process and message queues are dynamic therefore their sizes are
- *          free to grow/shrink as needed. These queues also contain a pointer
- *          to both the next and previous element in the queue. If only one element
- *          exists, the circular nature has these pointers pointing to itself.
- *          Memory for PCBs stored is allocated during process registration:
- *              see reg_process() in 'process.cpp'.
- *          Memory for MSGs stored is allocated during message creation:
- *              see KSendMessage() in 'KernelCalls.cpp'.
- *          Memory for a message or PCB is freed on remove() which is a member function
- *          for both pqueue and mqueue.
- */
-#pragma once                        // ensure file is included only once in compilation
-
-/**************************************************
- *                  PROCESSES
- *************************************************/
-
-/* Process Control Block Structure */
-class pcb {
-public:
-    pcb* next;                      // pointer to next PCB
-    pcb* prev;                      // pointer to previous PCB
-    unsigned long sp;               // location of process stack pointer
-    unsigned long pid;              // PID of process
-    unsigned long priority;         // priority of process
-    bool blocked;                   // flag indicating if process is blocked or not (not sure if needed)
-    pcb(void);                      // constructor for new PCB
-    ~pcb(void);                     // custom destructor for PCB
-};
-
-/* Process Queues */
-class p_queue {
-private:
-    pcb* front;                     // pointer to the PCB at the front (head) of the queue
-public:
-    p_queue(void);                  // constructor of an empty queue
-    ~p_queue(void);                 // destructor for the process queue (never called)
-    void enqueue(pcb* ptr);         // put x at the back of the list
-    void dequeue(pcb* ptr);         // dequeues a PCB without deleting (for swapping queues)
-    pcb* get_front(void);           // returns pointer to PCB at the front of the queue
-    bool remove(pcb* ptr);          // dequeues a PCB and frees its memory
-    bool empty(void) const;         // check for empty queue
-};
-
-/**************************************************
- *                  MESSAGES
- *************************************************/
-
-/* Message Structure */
-class msgcontainer {
-public:
-    msgcontainer* next;             // pointer to the next MSG
-    msgcontainer* prev;             // pointer to the previous MSG
-    int size;                       // size of the message being passed|queued
-    char* msg;                      // the message itself
-    msgcontainer(void);             // constructor for a message container
-    ~msgcontainer(void);            // destructor for a message container
-};
-
-/* Message Queues */
-class m_queue {
-private:
-    msgcontainer* front;            // pointer to the MSG at the front (head) of the queue
-public:
-    pcb* owner;                     // the PCB associated with process bound to queue
-    m_queue(void);                  // constructor of an empty queue
-    ~m_queue();                     // destructor for the message queue (never called)
-    void enqueue(msgcontainer* ptr);// put x at the back of the list
-    msgcontainer* get_front(void);  // get the node at the front of the list
-    bool remove(msgcontainer* ptr); // dequeues a message container and frees its memory
-    bool empty(void) const;         // check for empty queue
-    void clear(void);               // empty the message queue and delete any queued messages
-};
-
-/**************************************************
- *                    UART
- *************************************************/
-
-/* UART RX and TX Queues */
-class u_queue {
-private:
-    int max;                        // maximum size of the queue
-    int items;                      // number of items in the queue
-    int insloc;                     // next location to insert
-    int remloc;                     // next location to remove
-    char* data;                     // vector holding the queue of items
-public:
-    u_queue(int sz);                // constructor, max = sz
-    ~u_queue();                     // destructor
-    void enqueue(char UART_RX_CHAR);// put the char onto the queue
-    char dequeue(void);             // get char at the head of the queue
-    bool empty(void) const;         // check for empty queue
-};
+/*
+ * File: queues.h
+ * Author: Stephen Sampson
+ * Original Date: 9/23/2017 (Expanded A#1 Implementation)
+ * Revised Date: December 5th 2017
+ * Purpose: This file contains the structure of the queue classes used
+ *          to create priority process queues, timer wheel slots, message
+ *          queues, and UART0 TX/RX queues.
+ *          All queues are circular in nature with UART queues being of
+ *          a fixed size (defined in globals.h).
+ *          Process and message queues are dynamic therefore their sizes are
+ *          free to grow/shrink as needed. These queues also contain a pointer
+ *          to both the next and previous element in the queue. If only one element
+ *          exists, the circular nature has these pointers pointing to itself.
+ *          PCBs stored are taken from a static pool during process registration:
+ *              see reg_proc() in 'process.cpp' and 'pools.h'.
+ *          MSGs stored are taken from a slab during message creation:
+ *              see KSendMessage() in 'KernelCalls.cpp' and 'pools.h'.
+ *          A message is returned to its slab on m_queue::remove(); a PCB
+ *          is returned to its pool by pcb_free() once it is dequeued.
+ */
+#pragma once                        // ensure file is included only once in compilation
+
+/**************************************************
+ *                  PROCESSES
+ *************************************************/
+
+/* Deadline and release statistics of a periodic (EDF) process */
+struct edfstats {
+    unsigned long jobs;             // jobs completed (PWaitNextPeriod() calls)
+    unsigned long misses;           // jobs completed at or after their deadline
+    unsigned long releases;         // releases timed for jitter
+    unsigned long jitter_min;       // least cycles from release to running
+    unsigned long jitter_max;       // most cycles from release to running
+    unsigned long jitter_total;     // sum of release jitter (for mean)
+};
+
+/* State of the current job of a periodic (EDF) process */
+enum edfjobstates {JOB_STARTED, JOB_WAITING, JOB_RELEASED};
+
+class p_queue;
+
+/* What a process that is not ready is waiting for (pcb::wait_state) */
+enum waitstates {WAIT_NONE, WAIT_RECEIVE, WAIT_SEND, WAIT_SLEEP, WAIT_PERIOD, WAIT_BUDGET,
+                 WAIT_REQUEST, WAIT_CALL, WAIT_REPLY};  // rendezvous: server awaiting a request, client awaiting the server, client awaiting the reply
+
+/* Process Control Block Structure */
+class pcb {
+public:
+    pcb* next;                      // pointer to next PCB
+    pcb* prev;                      // pointer to previous PCB
+    unsigned long sp;               // location of process stack pointer
+    unsigned long pid;              // PID of process
+    unsigned long priority;         // priority of process (raised above base_priority while inheriting)
+    unsigned long base_priority;    // priority the process was registered with
+    unsigned long inherited;        // highest priority passed on by processes waiting on it (0: none)
+    unsigned long designated;       // queues it is the designated sender of (QUEUE_BIT() of each)
+    unsigned int ready_since;       // value of 'ticks' when it last joined the back of its level (aging)
+    unsigned long aged;             // level aging raised the process to, 0 if not aged (dropped after its next quantum)
+    unsigned int wait_state;        // WAIT_NONE while ready, else what the process is waiting for (waitstates)
+    bool sleeping;                  // flag indicating if process is on the timer wheel (any timed wait)
+    pcb* tnext;                     // pointer to next PCB in the same timer wheel slot
+    pcb* tprev;                     // pointer to previous PCB in the same timer wheel slot
+    unsigned int wake_tick;         // value of 'ticks' at which a sleeping process is woken
+    bool terminated;                // flag indicating process has terminated (PCB freed on next switch)
+    unsigned long *stack;           // base of process stack (taken from stack pool)
+    unsigned stackclass;            // class of stack pool the stack belongs to
+    void *rcv_buf;                  // buffer of a blocked receive (where a MSG_LOAN pointer is stored)
+    unsigned int rcv_size;          // size of that buffer
+    unsigned int rcv_mode;          // MSG_COPY or MSG_LOAN
+    unsigned long *wait_rtn;        // where the result of a blocked receive or send is returned (stacked r0)
+    unsigned long rcv_set;          // queues a blocked receive is waiting on (QUEUE_BIT() of each)
+    bool rcv_any;                   // blocked in PReceiveAny() (result also names the queue)
+    void *snd_msg;                  // message of a send blocked on a full queue
+    unsigned int snd_size;          // its size
+    unsigned int snd_mode;          // MSG_COPY or MSG_LOAN
+    unsigned int snd_priority;      // its priority (msgpriorities)
+    unsigned int snd_queue;         // queue it is waiting to be sent to (or the queue of the rendezvous server it calls)
+    unsigned long *rcv_client;      // where a blocked PReceiveRequest() returns the client
+    p_queue *waitlist;              // list of the queue a blocked process is parked on (waiters, senders, clients or awaiting)
+    unsigned long bound;            // queues the process has bound (QUEUE_BIT() of each)
+    unsigned long long run_cycles;  // CPU cycles the process has run for
+    unsigned long switches;         // number of times the process has been switched in
+    unsigned long dispatched;       // cycle count when it was last switched in
+    unsigned int quantum;           // ticks the process runs before the next one of its priority
+    unsigned int slice_left;        // ticks left of the current quantum
+    unsigned int budget;            // ticks of CPU allowed per budget period (0 = unlimited)
+    unsigned int budget_period;     // length of a budget period (ticks)
+    unsigned int budget_used;       // ticks used in the current budget period
+    unsigned int period_start;      // value of 'ticks' at which the current budget period began
+    unsigned long overruns;         // number of times the budget ran out (process throttled)
+    bool edf;                       // process is in the EDF class (ordered by deadline, not round-robin)
+    unsigned int period;            // EDF: ticks between releases
+    unsigned int rel_deadline;      // EDF: ticks from release to deadline
+    unsigned int release;           // EDF: tick the current job was released
+    unsigned int abs_deadline;      // EDF: tick the current job is due
+    unsigned int heap_index;        // EDF: position in the EDF ready heap
+    unsigned int job_state;         // EDF: JOB_WAITING for release, JOB_RELEASED but not yet run, or JOB_STARTED
+    unsigned long release_stamp;    // EDF: cycle count at which the current job was released
+    edfstats edf_stats;             // EDF: deadline misses and release jitter
+    pcb(void);                      // constructor for new PCB
+    bool is_ready(void) const;      // process is in a ready queue (not waiting or terminated)
+    ~pcb(void);                     // custom destructor for PCB
+};
+
+/* Accounting for one process, returned by PProcStats() */
+struct procstats {
+    unsigned long pid;              // process to report on (set by the caller)
+    unsigned long priority;         // priority of process
+    unsigned long long run_cycles;  // CPU cycles the process has run for (including the current run)
+    unsigned long switches;         // number of times the process has been switched in
+    unsigned long stack_size;       // size of its stack (bytes)
+    unsigned long stack_used;       // most of that stack ever used (bytes)
+    unsigned long overruns;         // number of times it was throttled for overrunning its budget
+    edfstats edf;                   // deadline misses and release jitter (EDF processes only)
+};
+
+/* What one process is waiting for, returned by PWaitReport() */
+struct waitinfo {
+    unsigned long pid;              // process
+    unsigned int state;             // what it waits for (waitstates, never WAIT_NONE)
+    unsigned long queues;           // queues it waits on, sends to or has called (QUEUE_BIT() of each)
+    bool timed;                     // wait ends at 'wake_tick' at the latest (sleep, period, budget or receive timeout)
+    unsigned int wake_tick;         // value of 'ticks' at which a timed wait ends
+};
+
+/* Process Queues */
+class p_queue {
+private:
+    pcb* front;                     // pointer to the PCB at the front (head) of the queue
+public:
+    p_queue(void);                  // constructor of an empty queue
+    ~p_queue(void);                 // destructor for the process queue (never called)
+    void enqueue(pcb* ptr);         // put x at the back of the list
+    void dequeue(pcb* ptr);         // dequeues a PCB without deleting (for swapping queues)
+    pcb* get_front(void);           // returns pointer to PCB at the front of the queue
+    void rotate(void);              // move the front PCB to the back (round-robin)
+    bool empty(void) const;         // check for empty queue
+};
+
+/* Timer Queues (one per timer wheel slot). Linked through tnext/tprev so
+ * a PCB may sit in a timer slot and a process queue at the same time */
+class t_queue {
+private:
+    pcb* front;                     // pointer to the PCB at the front (head) of the queue
+public:
+    t_queue(void);                  // constructor of an empty queue
+    ~t_queue(void);                 // destructor for the timer queue (never called)
+    void enqueue(pcb* ptr);         // put x at the back of the list
+    void dequeue(pcb* ptr);         // dequeues a PCB without deleting
+    pcb* get_front(void);           // returns pointer to PCB at the front of the queue
+    bool empty(void) const;         // check for empty queue
+};
+
+/**************************************************
+ *                  MESSAGES
+ *************************************************/
+
+#define MAX_MSG_SIZE    256         // Longest message copied by the kernel (MSG_LOAN messages may be longer)
+#define MSG_BODY_WORDS  (MAX_MSG_SIZE / sizeof(unsigned long))  // words of storage for a copied message
+
+/* Receive timeouts (ticks). The mode and the timeout of a receive (or the full
+ * queue option of a send) share one kernel call argument register: mode in the
+ * low MSG_MODE_BITS bits */
+#define WAIT_FOREVER    0x0FFFFFFF      // receive blocks until a message arrives
+#define RDV_SIZE_BITS   16              // PSendReceive(): request size and reply size share a register
+#define MSG_MODE_BITS   4
+#define MSG_MODE_MASK   ((1 << MSG_MODE_BITS) - 1)
+
+/* Receiving from a set of queues (PReceiveAny()). A set has one bit per queue;
+ * the result carries the queue a message came from above the byte count */
+#define QUEUE_BIT(q)    (1UL << (q))
+#define ANY_SHIFT       24
+#define ANY_QUEUE(r)    ((unsigned int)(r) >> ANY_SHIFT)                // queue a PReceiveAny() result came from
+#define ANY_BYTES(r)    ((unsigned int)(r) & ((1UL << ANY_SHIFT) - 1))  // bytes received
+
+/* Message passing modes. MSG_COPY copies the message into the kernel on send
+ * and out to the receiver's buffer. MSG_LOAN passes the sender's buffer itself:
+ * the sender gives up the buffer and the receiver is handed a pointer to it */
+enum msgmodes {MSG_COPY, MSG_LOAN};
+
+/* Binding modes. A BIND_EXCLUSIVE queue has one owner. A BIND_SHARED queue is
+ * bound by a pool of receivers; each message goes to one of them, the one that
+ * has waited longest if any are blocked */
+enum bindmodes {BIND_EXCLUSIVE, BIND_SHARED};
+
+/* What a send to a queue holding its capacity of messages does: wait in the
+ * queue's blocked senders for space, return QUEUE_FULL, or drop the oldest
+ * queued message to make room (telemetry that only needs the latest values).
+ * Blocked senders queue first; if the message containers run out before they
+ * have, SEND_FAIL and SEND_OVERWRITE sends get NO_MEMORY, not QUEUE_FULL */
+enum sendfullmodes {SEND_BLOCK, SEND_FAIL, SEND_OVERWRITE};
+
+/* Occupancy of a message queue, returned by PQueueStats() */
+struct queuestats {
+    unsigned int capacity;          // most messages queued at once (0 = unbounded)
+    unsigned int depth;             // messages queued now
+    unsigned int high_water;        // most messages ever queued at once since bound
+    unsigned long blocked_sends;    // sends that waited for space (SEND_BLOCK)
+    unsigned long failed_sends;     // sends refused with QUEUE_FULL (SEND_FAIL, or SEND_OVERWRITE outranked by every queued message)
+    unsigned long overwritten;      // messages dropped to make room (SEND_OVERWRITE)
+};
+
+/* Message priorities. A queue keeps a FIFO of messages per level and delivers
+ * the front of the highest non empty level first (found with one CLZ), so an
+ * urgent message does not wait behind a backlog of routine ones */
+#define MSG_PRIORITIES  4
+#define MSG_LEVEL_BIT(p) (1U << (p))    // bit representing message priority level p in m_queue::levels
+enum msgpriorities {MSG_LOW, MSG_NORMAL, MSG_HIGH, MSG_URGENT};
+#define MSG_PRIO_SHIFT  8               // a send's mode register: mode | full option << MSG_MODE_BITS | priority << MSG_PRIO_SHIFT
+
+/* Message Structure */
+class msgcontainer {
+public:
+    msgcontainer* next;             // pointer to the next MSG
+    msgcontainer* prev;             // pointer to the previous MSG
+    int size;                       // size of the message being passed|queued
+    char* msg;                      // the message itself (body, or the sender's buffer if loaned)
+    bool loan;                      // message is a loaned buffer (MSG_LOAN) rather than a copy
+    unsigned int priority;          // level of the message (msgpriorities)
+    unsigned long body[MSG_BODY_WORDS]; // copy of the message (MSG_COPY), word aligned for fast copy
+    msgcontainer(void);             // constructor for a message container
+    ~msgcontainer(void);            // destructor for a message container
+};
+
+/* Message Queues */
+class m_queue {
+private:
+    msgcontainer* front[MSG_PRIORITIES];    // pointer to the MSG at the front (head) of each priority level
+    unsigned int levels;            // bit per priority level holding messages (MSG_LEVEL_BIT())
+public:
+    pcb* owner;                     // the PCB associated with process bound to queue (NULL if shared)
+    bool shared;                    // queue is bound BIND_SHARED by a pool of receivers
+    unsigned int members;           // processes bound to the queue
+    p_queue waiters;                // receivers blocked on the queue (longest waiting at the front)
+    p_queue senders;                // senders blocked until the queue has space (longest waiting at the front)
+    p_queue clients;                // rendezvous clients whose requests the owner has not yet received
+    p_queue awaiting;               // rendezvous clients received by the owner, awaiting its reply
+    queuestats stats;               // capacity, depth and high water mark
+    pcb* sender;                    // process designated to send to the queue (inherits the owner's priority while it waits)
+    m_queue(void);                  // constructor of an empty queue
+    ~m_queue();                     // destructor for the message queue (never called)
+    void enqueue(msgcontainer* ptr);// put x at the back of the list
+    msgcontainer* get_front(void);  // get the node to deliver next (front of the highest level)
+    msgcontainer* get_lowest(void); // get the oldest node of the lowest level
+    bool remove(msgcontainer* ptr); // dequeues a message container and returns it to the slab
+    bool empty(void) const;         // check for empty queue
+    bool full(void) const;          // check for a queue holding its capacity of messages
+    void clear(void);               // empty the message queue and free any queued messages
+};
+
+/**************************************************
+ *                    UART
+ *************************************************/
+
+/* UART RX and TX Queues */
+class u_queue {
+private:
+    int max;                        // maximum size of the queue
+    int items;                      // number of items in the queue
+    int insloc;                     // next location to insert
+    int remloc;                     // next location to remove
+    char* data;                     // vector holding the queue of items
+public:
+    u_queue(int sz);                // constructor, max = sz
+    ~u_queue();                     // destructor
+    void enqueue(char UART_RX_CHAR);// put the char onto the queue
+    char dequeue(void);             // get char at the head of the queue
+    bool empty(void) const;         // check for empty queue
+    int space(void) const;          // number of chars that can still be queued
+};
@@ -0,0 +1,198 @@
+/*
+ * File: scheduler.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: See scheduler.h. Every change to the ready process queues goes
+ *          through these functions so that ready_bitmap always mirrors which
+ *          of procqueue[IDLE..HIGHEST] (and the EDF heap) are non empty.
+ */
+
+#include "globals.h"
+#include "scheduler.h"
+#include "svc.h"
+#include "trace.h"
+#include "pools.h"
+#include "kernel.h"
+
+/* EDF ready heap: binary min-heap of ready EDF processes keyed by absolute
+ * deadline, each PCB holding its own index so it can be removed in O(log n) */
+static pcb *edfheap[PCB_POOL_SIZE];
+static unsigned int edfcount = 0;
+
+/* Deadline of 'a' is before that of 'b' (tick counts wrap) */
+static bool edf_before(const pcb *a, const pcb *b) {
+    return (int)(a->abs_deadline - b->abs_deadline) < 0;
+}
+
+/* Place PCB at heap position i */
+static void edf_place(pcb *ptr, unsigned int i) {
+    edfheap[i] = ptr;
+    ptr->heap_index = i;
+}
+
+/* Move the PCB at position i towards the root while it is due first */
+static void edf_sift_up(unsigned int i) {
+    pcb *ptr = edfheap[i];
+    while (i > 0 && edf_before(ptr, edfheap[(i - 1) / 2])) {
+        edf_place(edfheap[(i - 1) / 2], i);
+        i = (i - 1) / 2;
+    }
+    edf_place(ptr, i);
+}
+
+/* Move the PCB at position i towards the leaves while a child is due first */
+static void edf_sift_down(unsigned int i) {
+    pcb *ptr = edfheap[i];
+    while (TRUE) {
+        unsigned int child = 2 * i + 1;
+        if (child >= edfcount)
+            break;
+        if (child + 1 < edfcount && edf_before(edfheap[child + 1], edfheap[child]))
+            child++;
+        if (!edf_before(edfheap[child], ptr))
+            break;
+        edf_place(edfheap[child], i);
+        i = child;
+    }
+    edf_place(ptr, i);
+}
+
+/* Add PCB to the EDF heap */
+static void edf_insert(pcb *ptr) {
+    edf_place(ptr, edfcount++);
+    edf_sift_up(ptr->heap_index);
+}
+
+/* Take PCB out of the EDF heap, filling its place with the last entry */
+static void edf_remove(pcb *ptr) {
+    unsigned int i = ptr->heap_index;
+    pcb *last = edfheap[--edfcount];
+    if (last == ptr)
+        return;
+    edf_place(last, i);
+    edf_sift_up(i);
+    edf_sift_down(last->heap_index);
+}
+
+/* Place PCB at the back of the queue for its priority (or in the EDF heap)
+ * and mark that level ready */
+void ready_enqueue(pcb *ptr) {
+    ptr->slice_left = ptr->quantum;         // joins the back of its level with a full quantum
+    ptr->ready_since = ticks;
+    if (ptr->edf)
+        edf_insert(ptr);
+    else
+        procqueue[ptr->priority].enqueue(ptr);
+    ready_bitmap |= PRIORITY_BIT(ptr->priority);
+}
+
+/* Take PCB out of the queue for its priority, clearing the level if it is now empty */
+void ready_dequeue(pcb *ptr) {
+    if (ptr->edf) {
+        edf_remove(ptr);
+        if (edfcount == 0)
+            ready_bitmap &= ~PRIORITY_BIT(ptr->priority);
+        return;
+    }
+    procqueue[ptr->priority].dequeue(ptr);
+    if (procqueue[ptr->priority].empty())
+        ready_bitmap &= ~PRIORITY_BIT(ptr->priority);
+}
+
+/* Round-robin: PCB at the front of its level goes to the back once its quantum
+ * expires (or it yields), with a full quantum for its next turn. EDF processes
+ * keep their place: their order is set by deadline alone */
+void ready_rotate(pcb *ptr) {
+    ptr->slice_left = ptr->quantum;
+    ptr->ready_since = ticks;
+    if (!ptr->edf)
+        procqueue[ptr->priority].rotate();
+}
+
+/* Change the (effective) priority of a fixed priority PCB. A ready PCB joins
+ * the back of its new level; otherwise it is queued there once it wakes */
+void ready_reprioritise(pcb *ptr, unsigned long priority) {
+    if (ptr->priority == priority)
+        return;
+    if (ptr->is_ready()) {
+        ready_dequeue(ptr);
+        ptr->priority = priority;
+        ready_enqueue(ptr);
+    } else
+        ptr->priority = priority;
+}
+
+/* Make a blocked or sleeping PCB ready. If it outranks the running process
+ * (or is an EDF process due before it) PendSV is pended so the switch happens
+ * on exit from the kernel call or interrupt that woke it, rather than at the
+ * end of the running quantum. A periodic process woken for its next release
+ * has the release time noted for its jitter statistics */
+void ready_wake(pcb *ptr) {
+    trace(TR_WAKE, ptr->pid, running->pid);
+    ptr->wait_state = WAIT_NONE;
+    if (ptr->job_state == JOB_WAITING) {
+        ptr->job_state = JOB_RELEASED;
+        ptr->release_stamp = CYCLES();
+    }
+    ready_enqueue(ptr);
+#if WAKE_PREEMPTION
+    if (ptr->priority > running->priority || !running->is_ready()
+            || (ptr->edf && running->edf && edf_before(ptr, running)))
+        TriggerPendSV();
+#endif
+}
+
+#if AGING
+static unsigned int age_level = 0;      // next level ready_age() examines
+
+/* Aging, one level per tick so the cost per tick is constant: every level
+ * below AGING_CAP is visited once every AGING_CAP ticks. The longest waiting
+ * process of the level (its front, or the one behind the running process) is
+ * raised to its own level plus one for every AGING_TICKS it has waited */
+void ready_age(void) {
+    unsigned int level = age_level;
+    age_level = (age_level + 1) % AGING_CAP;
+    if (level == IDLE || !(ready_bitmap & PRIORITY_BIT(level)))
+        return;
+    pcb *ptr = procqueue[level].get_front();
+    if (ptr == running)                     // running is not waiting
+        ptr = ptr->next;
+    if (ptr == running)
+        return;
+    unsigned int waited = ticks - ptr->ready_since;
+    unsigned long target = ptr->base_priority + waited / AGING_TICKS;
+    if (target > AGING_CAP)
+        target = AGING_CAP;
+    if (target <= level)
+        return;
+    ptr->aged = target;
+    ready_reprioritise(ptr, target);
+    ptr->ready_since = ticks - waited;      // keeps counting from when it started waiting
+    if (target > running->priority)         // now outranks the running process
+        TriggerPendSV();
+}
+#endif
+
+/* Drop the level aging raised a process to. It falls back to its own priority,
+ * or to the one it inherited from processes still waiting on it, without
+ * looking at what they are */
+void ready_unage(pcb *ptr) {
+    ptr->aged = 0;
+    ready_reprioritise(ptr, ptr->inherited > ptr->base_priority ? ptr->inherited : ptr->base_priority);
+}
+
+/* Highest priority level with a waiting to run process. The idle process is
+ * always ready so ready_bitmap is never zero once processes are registered */
+int highest_priority(void) {
+    return (NUM_PRIORITIES - 1) - CLZ(ready_bitmap);
+}
+
+/* Process to run next: front of the highest priority ready level, or the
+ * earliest deadline if that level is the EDF class */
+pcb *ready_front(void) {
+    int level = highest_priority();
+    if (level == EDF_PRIORITY)
+        return edfheap[0];
+    return procqueue[level].get_front();
+}
@@ -0,0 +1,49 @@
+/*
+ * File: scheduler.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Ready set of the kernel. Each priority level owns a round-robin
+ *          process queue (procqueue[]) and one bit in ready_bitmap which is
+ *          set whenever that queue holds a waiting to run process. The highest
+ *          priority ready level is then found with a single count-leading-zeros
+ *          instruction regardless of the number of priority levels.
+ *          One level, EDF_PRIORITY, is the earliest deadline first class:
+ *          its ready processes are kept in a heap ordered by absolute
+ *          deadline instead of a round-robin queue. Fixed priority processes
+ *          above it preempt periodic processes; those below run in their slack.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "queues.h"                     // pcb and p_queue object types
+
+/* Count leading zeros (single CLZ instruction on the Cortex-M4) */
+#if defined(__TI_COMPILER_VERSION__)
+#define CLZ(x)  _norm(x)                // TI intrinsic for CLZ
+#else
+#define CLZ(x)  __builtin_clz(x)        // GCC/Clang builtin for CLZ
+#endif
+
+#define PRIORITY_BIT(p) (1UL << (p))    // bit representing priority level p in ready_bitmap
+#define WAKE_PREEMPTION TRUE            // switch as soon as a higher priority process is woken
+#define EDF_PRIORITY    (HIGH + 4)      // level of the EDF class (reserved, see reg_edf())
+
+/* Aging: a ready process that has waited AGING_TICKS ticks without running
+ * moves up one level per AGING_TICKS waited, to at most AGING_CAP (below the
+ * EDF class and HIGHEST), and drops back once it has run for a quantum */
+#ifndef AGING
+#define AGING           FALSE           // enable|disable anti-starvation aging
+#endif
+#define AGING_TICKS     4               // ticks waited per level of boost
+#define AGING_CAP       (EDF_PRIORITY - 1)  // highest level aging can raise a process to
+
+void ready_enqueue(pcb *ptr);           // place PCB at back of its priority queue and mark level ready
+void ready_dequeue(pcb *ptr);           // take PCB out of its priority queue (clearing level if now empty)
+void ready_rotate(pcb *ptr);            // move PCB (front of its level) to the back of its level
+void ready_wake(pcb *ptr);              // make a blocked/sleeping PCB ready, preempting if it outranks running
+int highest_priority(void);             // highest priority level containing a waiting to run process
+void ready_reprioritise(pcb *ptr, unsigned long priority);  // change PCB's priority, moving it to its new level if ready
+void ready_age(void);                   // aging: examine one level (called every tick)
+void ready_unage(pcb *ptr);             // drop an aging boost, keeping any inherited priority (O(1))
+pcb *ready_front(void);                 // process to run next (front of highest level, or earliest deadline)
@@ -1,134 +1,158 @@
-/*
- * File: svc.cpp
- * Original Source: http://lh.ece.dal.ca/eced4402/
- * Modified By: Stephen Sampson
- * Revised Date: December 5th 2017
- * Purpose: Supervisor call (SVC) handler
- */
-
-#include <stdio.h>
-#include "svc.h"
-#include "process.h"
-#include "queues.h"
-#include "KernelCalls.h"
-#include "systick.h"
-#include "globals.h"
-#include "uart.h"
-#include "message.h"
-
-/* Supervisor call (trap) entry point */
-extern "C" void SVCall(void) {
-
-    /* Save LR for return via MSP or PSP */
-    __asm("     PUSH    {LR}");
-
-    /* Trapping source: MSP or PSP? */
-    __asm("     TST     LR,#4");        // Bit #4 indicates MSP (0) or PSP (1)
-    __asm("     BNE     RtnViaPSP");
-
-    /* Trapping source is MSP - save r4-r11 on stack (default, so just push) */
-    __asm("     PUSH    {r4-r11}");
-    __asm("     MRS r0,msp");
-    __asm("     BL  SVCHandler");       // r0 is MSP
-    __asm("     POP {r4-r11}");
-    __asm("     POP     {PC}");
-
-    /* Trapping source is PSP - save r4-r11 on psp stack (MSP is active stack) */
-    __asm("RtnViaPSP:");
-    __asm("     mrs     r0,psp");
-    __asm("     stmdb   r0!,{r4-r11}"); // Store multiple, decrement before
-    __asm("     msr psp,r0");
-    __asm("     BL  SVCHandler");       // r0 Is PSP
-
-    /* Restore r4..r11 from trapping process stack  */
-    __asm("     mrs     r0,psp");
-    __asm("     ldmia   r0!,{r4-r11}"); // Load multiple, increment after
-    __asm("     msr psp,r0");
-    __asm("     POP     {PC}");
-
-}
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-/* Supervisor call handler */
-extern "C" void SVCHandler(struct stack_frame *argptr) {
-
-    if(force_psp == TRUE){              // Force a return using PSP
-
-        /* Ensure PSP points to the address of R0 */
-        set_PSP(running -> sp + 8 * sizeof(unsigned int));
-        force_psp  = FALSE;             // update flag
-        SysTickStart();                 // start systick
-
-        /* Change LR to indicate return to Thread mode using the PSP */
-        __asm(" movw    LR,#0xFFFD");   // Lower 16 [and clear top 16]
-        __asm(" movt    LR,#0xFFFF");   // Upper 16 only
-        __asm(" bx  LR");               // Force return to PSP
-
-    } else {                            // Handle kernel call using args in R7
-
-        kcallargs *kcaptr = (struct kcallargs*)argptr->r7;
-        /* Switch on code provided to kernel by pkCall() */
-        switch(kcaptr->code){
-            /* Bind running process to queue specified in arguments */
-            case BIND:
-                kcaptr->rtnvalue = KBind(kcaptr->arg1);
-                break;
-            /* Return value of running PID */
-            case GETID:
-                kcaptr->rtnvalue = KGetPID();
-                break;
-            /* Terminate running process and switch running to next process */
-            case TERMINATE:
-                KTerminateProcess();
-                break;
-            /* Handle IPC Operation (Send/Receive) */
-            struct p_msg *pmsg;         // structure needed in both send and receive
-            /* Send specified message to specified message queue (if it has an owner) */
-            case SEND:
-                pmsg = (struct p_msg *) kcaptr->arg1;
-                kcaptr->rtnvalue = KSendMessage(pmsg->queueID, pmsg->msg, pmsg->msg_size);
-                break;
-            /* Receive message from specified message queue if it exists. Block process if not. */
-            case RECEIVE:
-                pmsg = (struct p_msg *) kcaptr->arg1;
-                kcaptr->rtnvalue = (int) KReceiveMessage(pmsg->queueID, pmsg->msg, pmsg->msg_size);
-                break;
-            /* Default handler to shut compiler up */
-            default:
-                kcaptr -> rtnvalue = -1;
-                break;
-        }
-    }
-}
-
-/* Signal that the PendSV handler is to be called on exit */
-void TriggerPendSV(void) {
-    NVIC_INT_CTRL_R |= TRIGGER_PENDSV;
-}
-
-/* Save process state, switch to next waiting to run process, and restore that state */
-extern "C" void PendSVHandler(void) {
-    save_registers();
-    next_process();
-    restore_registers();
-}
-
-
+/*
+ * File: svc.cpp
+ * Original Source: http://lh.ece.dal.ca/eced4402/
+ * Modified By: Stephen Sampson
+ * Revised Date: December 5th 2017
+ * Purpose: Supervisor call (SVC) handler
+ */
+
+#include <stdio.h>
+#include "svc.h"
+#include "process.h"
+#include "queues.h"
+#include "KernelCalls.h"
+#include "systick.h"
+#include "globals.h"
+#include "uart.h"
+#include "kernel.h"
+
+/* Kernel call handlers. Each takes its arguments from r0-r3 of the caller's
+ * stacked frame (r4-r11 of the frame are not valid); the value returned is
+ * placed in the frame's r0 */
+static int KCallGetPID(stack_frame *) {
+    return KGetPID();
+}
+
+static int KCallBind(stack_frame *args) {
+    return KBind(args->r0, args->r1, args->r2);
+}
+
+/* A send that blocks on a full queue is completed by a receive making space,
+ * which writes the result to r0. r3 holds the mode, the full queue option and
+ * the message priority */
+static int KCallSend(stack_frame *args) {
+    return KSendMessage(args->r0, (void *) args->r1, args->r2, args->r3 & MSG_MODE_MASK,
+                        (args->r3 >> MSG_MODE_BITS) & MSG_MODE_MASK, args->r3 >> MSG_PRIO_SHIFT, &args->r0);
+}
+
+/* A receive that blocks is completed by the sender (or its timeout), which
+ * writes the result to r0. r3 holds the mode and the timeout */
+static int KCallReceive(stack_frame *args) {
+    return KReceiveMessage(args->r0, (void *) args->r1, args->r2, args->r3 & MSG_MODE_MASK,
+                           args->r3 >> MSG_MODE_BITS, &args->r0);
+}
+
+static int KCallReceiveAny(stack_frame *args) {
+    return KReceiveAny(args->r0, (void *) args->r1, args->r2, args->r3 & MSG_MODE_MASK,
+                       args->r3 >> MSG_MODE_BITS, &args->r0);
+}
+
+static int KCallWaitReport(stack_frame *args) {
+    return KWaitReport((waitinfo *) args->r0, args->r1);
+}
+
+static int KCallQueueStats(stack_frame *args) {
+    return KQueueStats(args->r0, (queuestats *) args->r1);
+}
+
+/* Rendezvous calls block until the other side completes them through r0. The
+ * request and reply sizes of PSendReceive() share r2 */
+static int KCallSendReceive(stack_frame *args) {
+    return KSendReceive(args->r0, (void *) args->r1, args->r2 & ((1UL << RDV_SIZE_BITS) - 1), (void *) args->r3,
+                        args->r2 >> RDV_SIZE_BITS, &args->r0);
+}
+
+static int KCallReceiveRequest(stack_frame *args) {
+    return KReceiveRequest(args->r0, (void *) args->r1, args->r2, (unsigned long *) args->r3, &args->r0);
+}
+
+static int KCallReply(stack_frame *args) {
+    return KReply(args->r0, (void *) args->r1, args->r2);
+}
+
+static int KCallTerminate(stack_frame *) {
+    KTerminateProcess();
+    return SUCCESS;
+}
+
+static int KCallSleep(stack_frame *args) {
+    return KSleep(args->r0);
+}
+
+static int KCallYield(stack_frame *) {
+    return KYield();
+}
+
+static int KCallStats(stack_frame *args) {
+    return KProcStats((procstats *) args->r0);
+}
+
+static int KCallWaitPeriod(stack_frame *) {
+    return KWaitNextPeriod();
+}
+
+static int KCallDesignate(stack_frame *args) {
+    return KDesignateSender(args->r0, args->r1);
+}
+
+/* Kernel call handlers, indexed by the code in r12 (order of kernelcallcodes).
+ * Calls that can never switch processes take the fast path out of SVCall() */
+static const kcallentry kcalltable[NUM_KCALLS] = {
+    {KCallGetPID,       FALSE},         // GETID
+    {KCallBind,         FALSE},         // BIND
+    {KCallSend,         TRUE},          // SEND (receiver may outrank the sender)
+    {KCallReceive,      TRUE},          // RECEIVE (blocks on an empty queue)
+    {KCallTerminate,    TRUE},          // TERMINATE
+    {KCallSleep,        TRUE},          // SLEEP
+    {KCallYield,        TRUE},          // YIELD
+    {KCallStats,        FALSE},         // STATS
+    {KCallWaitPeriod,   TRUE},          // WAITPERIOD
+    {KCallDesignate,    FALSE},         // DESIGNATE
+    {KCallReceiveAny,   TRUE},          // RECEIVEANY
+    {KCallWaitReport,   FALSE},         // WAITREPORT
+    {KCallQueueStats,   FALSE},         // QUEUESTATS
+    {KCallSendReceive,  TRUE},          // SENDRECEIVE (blocks until the reply)
+    {KCallReceiveRequest, TRUE},        // RECEIVEREQUEST (blocks until a request)
+    {KCallReply,        TRUE},          // REPLY (client may outrank the server)
+};
+
+/* Supervisor call handler. Returns TRUE if SVCall() is to switch processes
+ * (PendSVHandler()) before returning, in place of a pended PendSV */
+extern "C" int SVCHandler(struct stack_frame *argptr) {
+
+    if(force_psp == TRUE){              // Force a return using PSP
+
+        force_psp  = FALSE;             // update flag
+        running->dispatched = CYCLES(); // start charging the first process
+        running->switches++;
+        SysTickStart();                 // start systick
+        start_process(running -> sp);   // enter the first process (does not return)
+
+    } else if(argptr->r12 < NUM_KCALLS) {   // Kernel call: code in r12, arguments in r0-r3
+
+        const kcallentry *call = &kcalltable[argptr->r12];
+        argptr->r0 = call->handler(argptr);
+        if(call->may_switch && (NVIC_INT_CTRL_R & TRIGGER_PENDSV)) {
+            NVIC_INT_CTRL_R = CLEAR_PENDSV; // switch now rather than in a second exception
+            return TRUE;
+        }
+
+    } else {                            // Unknown kernel call
+
+        argptr->r0 = (unsigned long) ERROR;
+    }
+    return FALSE;
+}
+
+/* Signal that the PendSV handler is to be called on exit */
+void TriggerPendSV(void) {
+    NVIC_INT_CTRL_R |= TRIGGER_PENDSV;
+}
+
+/* Save process state, switch to next waiting to run process, and restore that
+ * state. Also entered from SVCall() for kernel calls that switch */
+extern "C" void PendSVHandler(void) {
+    save_registers();
+    next_process();
+    restore_registers();
+}
@@ -1,14 +1,28 @@
-/*
- * File: svc.h
- * Original Source: http://lh.ece.dal.ca/eced4402/
- * Modified By: Stephen Sampson
- * Revised Date: December 5th 2017
- * Purpose: Supervisor Call (SVC) Handler
- */
-
-#pragma once                            // ensure file is included only once in compilation
-
-#define NVIC_INT_CTRL_R (*((volatile unsigned long *) 0xE000ED04))
-#define TRIGGER_PENDSV 0x10000000
-void TriggerPendSV(void);               // trigger pendSV, called on systick
-extern "C" void PendSVHandler(void);    // handler for pendSV executed when no higher priority interrupts remain
+/*
+ * File: svc.h
+ * Original Source: http://lh.ece.dal.ca/eced4402/
+ * Modified By: Stephen Sampson
+ * Revised Date: December 5th 2017
+ * Purpose: Supervisor Call (SVC) Handler
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "port.h"                       // HWREG() (memory mapped registers)
+
+#define NVIC_INT_CTRL_R HWREG(0xE000ED04)
+#define TRIGGER_PENDSV 0x10000000
+#define CLEAR_PENDSV   0x08000000
+#define CLEAR_PENDST   0x02000000
+
+struct stack_frame;
+
+/* Kernel call table entry */
+struct kcallentry {
+    int (*handler)(stack_frame *args);  // performs the call, returns the caller's r0
+    bool may_switch;                    // call can block or wake a higher priority process
+};
+
+extern "C" int SVCHandler(struct stack_frame *argptr);  // kernel call dispatch, TRUE if a switch is due
+void TriggerPendSV(void);               // trigger pendSV, called on systick
+extern "C" void PendSVHandler(void);    // handler for pendSV executed when no higher priority interrupts remain
@@ -1,50 +1,154 @@
-/*
- * File: systick.cpp
- * Original Source: http://lh.ece.dal.ca/eced4402/SysTick.c
- * Modified By: Stephen Sampson
- * Revised Date: December 5th 2017
- * Purpose: SysTick definitions
- */
-
-#include "systick.h"
-#include "svc.h"
-#include "globals.h"
-#include "uart.h"
-
-/* Set the clock source to internal and enable the counter to interrupt */
-void SysTickStart(void) {
-    ST_CTRL_R |= ST_CTRL_CLK_SRC | ST_CTRL_ENABLE;
-}
-
-/* Clear the enable bit to stop the counter */
-void SysTickStop(void) {
-    ST_CTRL_R &= ~(ST_CTRL_ENABLE);
-}
-
-/* Set systick reload value to specified period (between 2 and 16777216)  */
-void SysTickPeriod(unsigned long Period) {
-    ST_RELOAD_R = Period - 1;
-}
-
-/* Set the interrupt bit in STCTRL */
-void SysTickIntEnable(void) {
-    ST_CTRL_R |= ST_CTRL_INTEN;
-}
-
-/* Clear the interrupt bit in STCTRL */
-void SysTickIntDisable(void) {
-    ST_CTRL_R &= ~(ST_CTRL_INTEN);
-}
-
-/* Trigger PendSV() and increment global counter of 'ticks' */
-extern "C" void SysTickHandler(void) {
-    ticks++;
-    TriggerPendSV();
-}
-
-/* A delay function used diagnostically to time process operations and
- * ensure a predictable number of time quantums pass before continuing */
-void _Delay(unsigned int cnt){
-    cnt += ticks;
-    while(ticks < cnt){}
-}
+/*
+ * File: systick.cpp
+ * Original Source: http://lh.ece.dal.ca/eced4402/SysTick.c
+ * Modified By: Stephen Sampson
+ * Revised Date: December 5th 2017
+ * Purpose: SysTick definitions
+ */
+
+#include "systick.h"
+#include "svc.h"
+#include "globals.h"
+#include "uart.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "trace.h"
+
+/* Tickless idle state */
+idleresidency idle_stats;                   // Idle residency counters (see systick.h)
+static unsigned long idle_sleep = 0;        // ticks spanned by the stretched SysTick period (0 = ticking normally)
+static unsigned long idle_first = 0;        // cycles that were left in the tick during which the sleep began
+static bool idle_partial = FALSE;           // sleep was cut short, only the remainder of the current tick is programmed
+
+/* Set the clock source to internal and enable the counter to interrupt */
+void SysTickStart(void) {
+    ST_CTRL_R |= ST_CTRL_CLK_SRC | ST_CTRL_ENABLE;
+}
+
+/* Clear the enable bit to stop the counter */
+void SysTickStop(void) {
+    ST_CTRL_R &= ~(ST_CTRL_ENABLE);
+}
+
+/* Set systick reload value to specified period (between 2 and 16777216)  */
+void SysTickPeriod(unsigned long Period) {
+    ST_RELOAD_R = Period - 1;
+}
+
+/* Set the interrupt bit in STCTRL */
+void SysTickIntEnable(void) {
+    ST_CTRL_R |= ST_CTRL_INTEN;
+}
+
+/* Clear the interrupt bit in STCTRL */
+void SysTickIntDisable(void) {
+    ST_CTRL_R &= ~(ST_CTRL_INTEN);
+}
+
+/* Charge a tick to a process with a CPU budget, starting a new budget period
+ * first if the last one has ended. TRUE if the budget is now used up */
+static bool budget_charge(pcb *ptr) {
+    unsigned int elapsed = ticks - ptr->period_start;
+    if (ptr->budget == 0)                   // unlimited
+        return FALSE;
+    if (elapsed >= ptr->budget_period) {    // replenish (periods stay on the same grid)
+        ptr->period_start += elapsed - elapsed % ptr->budget_period;
+        ptr->budget_used = 0;
+    }
+    return ++ptr->budget_used >= ptr->budget;
+}
+
+/* Increment global counter of 'ticks', wake due sleepers and charge the tick
+ * to the running process. PendSV is only triggered (to switch to the new
+ * front of its level) once the running process's quantum has expired, or when
+ * it has used up its budget and waits on the timer wheel for the next period */
+extern "C" void SysTickHandler(void) {
+#if TICKLESS_IDLE
+    if (idle_sleep != 0) {                  // end of a stretched period: account for every tick it spanned
+        ticks += idle_sleep;
+        if (!idle_partial) {
+            idle_stats.ticks_asleep += idle_sleep;
+            idle_stats.ticks_skipped += idle_sleep - 1;
+        }
+        idle_sleep = 0;
+        idle_partial = FALSE;
+        ST_RELOAD_R = MAX_WAIT - 1;         // back to one interrupt per tick
+        ST_CURRENT_R = 0;                   // counter already reloaded the stretched period, reload it now
+    } else
+#endif
+    ticks++;
+    timer_advance();                        // wake sleepers that are now due
+#if AGING
+    ready_age();                            // raise a process that has waited too long
+#endif
+    if (!running->is_ready())               // already leaving the CPU
+        return;
+    if (budget_charge(running)) {           // overran: throttle until the next budget period
+        running->overruns++;
+        trace(TR_THROTTLE, running->pid, running->period_start + running->budget_period);
+        ready_dequeue(running);
+        running->wait_state = WAIT_BUDGET;
+        timer_insert(running, running->period_start + running->budget_period);
+        TriggerPendSV();
+    } else if (ready_bitmap == PRIORITY_BIT(IDLE) && running->next == running) {
+        // idle alone: no quantum to expire, nothing to switch to
+    } else if (--running->slice_left == 0) {// quantum expired
+        unsigned long level = running->priority;
+        if (running->aged)                  // aged process has had its quantum: drop what aging gave it
+            ready_unage(running);
+        if (running->priority == level)     // still at the same level: to the back of it
+            ready_rotate(running);
+        TriggerPendSV();
+    }
+}
+
+/* Ticks until the next timed event the kernel must wake for (earliest sleeper) */
+unsigned long next_wakeup(void) {
+    return timer_next(TICKLESS_MAX_TICKS);
+}
+
+/* Only the idle process is ready: reprogram SysTick to interrupt at the next
+ * timed wakeup rather than every tick. The remainder of the current tick is
+ * kept so 'ticks' stays on the same grid once the sleep ends */
+void TicklessEnter(void) {
+    unsigned long sleep = next_wakeup();
+    if (sleep > TICKLESS_MAX_TICKS)         // SysTick can only time so many ticks
+        sleep = TICKLESS_MAX_TICKS;
+    if (idle_sleep != 0 || sleep < 2)       // already stretched, or nothing to gain
+        return;
+    idle_first = ST_CURRENT_R;
+    ST_RELOAD_R = idle_first + (sleep - 1) * MAX_WAIT - 1;
+    ST_CURRENT_R = 0;                       // load the stretched period
+    idle_sleep = sleep;
+    idle_stats.sleeps++;
+}
+
+/* A process became ready before the stretched period expired: count the ticks
+ * that have passed and program SysTick to fire at the end of the current tick.
+ * The period may have run out while interrupts were masked, its SysTick left
+ * pending: COUNTFLAG tells, and the count continues from a reloaded period */
+void TicklessExit(void) {
+    unsigned long elapsed, slept, left;
+    if (idle_sleep == 0 || idle_partial)    // not sleeping (or already corrected)
+        return;
+    elapsed = ST_RELOAD_R + 1 - ST_CURRENT_R;
+    if (ST_CTRL_R & ST_CTRL_COUNT)          // wrapped (before or since that read): the whole period, then the new one
+        elapsed = 2 * (ST_RELOAD_R + 1) - ST_CURRENT_R;
+    if (elapsed < idle_first) {             // still inside the tick the sleep began in
+        slept = 0;
+        left = idle_first - elapsed;
+    } else {
+        slept = 1 + (elapsed - idle_first) / MAX_WAIT;
+        left = MAX_WAIT - (elapsed - idle_first) % MAX_WAIT;
+    }
+    ticks += slept;
+    timer_advance();                        // wake sleepers due in the ticks slept through
+    idle_stats.ticks_asleep += slept;
+    idle_stats.ticks_skipped += slept;
+    idle_stats.early_wakes++;
+    ST_RELOAD_R = left - 1;
+    ST_CURRENT_R = 0;
+    NVIC_INT_CTRL_R = CLEAR_PENDST;         // a SysTick from the stretched period is counted above
+    idle_sleep = 1;                         // next SysTick completes the current tick
+    idle_partial = TRUE;
+}
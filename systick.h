@@ -1,32 +1,54 @@
-/*
- * File: systick.h
- * Original Source: http://lh.ece.dal.ca/eced4402/SysTick.c
- * Modified By: Stephen Sampson
- * Revised Date: December 5th 2017
- * Purpose: Systick Defines and Prototypes
- */
-
-#pragma once                                // ensure file is included only once in compilation
-
-/* SysTick Control and Status Register (STCTRL) */
-#define ST_CTRL_R   (*((volatile unsigned long *)0xE000E010))
-/* Systick Reload Value Register (STRELOAD) */
-#define ST_RELOAD_R (*((volatile unsigned long *)0xE000E014))
-
-/* SysTick defines */
-#define ST_CTRL_COUNT      0x00010000       // Count Flag for STCTRL
-#define ST_CTRL_CLK_SRC    0x00000004       // Clock Source for STCTRL
-#define ST_CTRL_INTEN      0x00000002       // Interrupt Enable for STCTRL
-#define ST_CTRL_ENABLE     0x00000001       // Enable for STCTRL
-#define MAX_WAIT           0x18B820         // Max Period
-
-/* SysTick function prototypes */
-void SysTickStart(void);                    // Set the clock source & enable counter to interrupt
-void SysTickStop(void);                     // Clear the enable bit to stop the counter
-void SysTickPeriod(unsigned long Period);   // Set period (2-->16777216)
-void SysTickIntEnable(void);                // Set the interrupt bit in STCTRL
-void SysTickIntDisable(void);               // Clear the interrupt bit in STCTRL
-extern "C" void SysTickHandler(void);       // The handler called on each systick()
-void _Delay(unsigned int cnt);              // Diagnostic delay function
-
-
+/*
+ * File: systick.h
+ * Original Source: http://lh.ece.dal.ca/eced4402/SysTick.c
+ * Modified By: Stephen Sampson
+ * Revised Date: December 5th 2017
+ * Purpose: Systick Defines and Prototypes
+ */
+
+#pragma once                                // ensure file is included only once in compilation
+
+#include "port.h"                           // HWREG() (memory mapped registers)
+
+/* SysTick Control and Status Register (STCTRL) */
+#define ST_CTRL_R   HWREG(0xE000E010)
+/* Systick Reload Value Register (STRELOAD) */
+#define ST_RELOAD_R HWREG(0xE000E014)
+/* Systick Current Value Register (STCURRENT). Any write clears it to 0 */
+#define ST_CURRENT_R HWREG(0xE000E018)
+
+/* SysTick defines */
+#define ST_CTRL_COUNT      0x00010000       // Count Flag for STCTRL
+#define ST_CTRL_CLK_SRC    0x00000004       // Clock Source for STCTRL
+#define ST_CTRL_INTEN      0x00000002       // Interrupt Enable for STCTRL
+#define ST_CTRL_ENABLE     0x00000001       // Enable for STCTRL
+#define MAX_WAIT           0x18B820         // Max Period
+#define ST_MAX_RELOAD      0x01000000       // SysTick is a 24 bit counter
+
+/* Tickless idle: when only the idle process is ready, SysTick is reprogrammed
+ * to expire at the next timed wakeup so the core can sleep through the ticks in between */
+#define TICKLESS_IDLE      TRUE             // enable|disable tickless idle
+#define TICKLESS_MAX_TICKS (ST_MAX_RELOAD / MAX_WAIT)   // longest sleep SysTick can time (in ticks)
+
+/* Idle residency counters (how long the core was kept asleep in tickless idle) */
+struct idleresidency {
+    unsigned long sleeps;                   // number of tickless sleeps entered
+    unsigned long early_wakes;              // sleeps cut short by something other than SysTick
+    unsigned long ticks_asleep;             // ticks covered by tickless sleeps
+    unsigned long ticks_skipped;            // SysTick interrupts that did not have to fire
+};
+
+extern idleresidency idle_stats;            // Idle residency counters (defined in systick.cpp)
+
+/* SysTick function prototypes */
+void SysTickStart(void);                    // Set the clock source & enable counter to interrupt
+void SysTickStop(void);                     // Clear the enable bit to stop the counter
+void SysTickPeriod(unsigned long Period);   // Set period (2-->16777216)
+void SysTickIntEnable(void);                // Set the interrupt bit in STCTRL
+void SysTickIntDisable(void);               // Clear the interrupt bit in STCTRL
+extern "C" void SysTickHandler(void);       // The handler called on each systick()
+unsigned long next_wakeup(void);            // ticks until the next timed event the kernel must wake for
+void TicklessEnter(void);                   // stretch SysTick to the next timed wakeup while idle
+void TicklessExit(void);                    // restore SysTick and correct 'ticks' after an early wake
+
+
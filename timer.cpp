@@ -0,0 +1,86 @@
+/*
+ * File: timer.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: See timer.h. Called from SysTickHandler() (and tickless idle) to
+ *          wake sleeping processes, and from the kernel calls that put them
+ *          to sleep.
+ */
+
+#include "globals.h"
+#include "timer.h"
+#include "scheduler.h"
+#include "KernelCalls.h"
+
+static unsigned int wheel_tick = 0;     // last tick whose slot has been processed
+
+/* Place PCB in the slot for wake_tick */
+void timer_insert(pcb *ptr, unsigned int wake_tick) {
+    ptr->wake_tick = wake_tick;
+    ptr->sleeping = TRUE;
+    timerwheel[TIMER_SLOT(wake_tick)].enqueue(ptr);
+}
+
+/* Take PCB out of its slot (O(1), the slot is found from its wake tick) */
+void timer_remove(pcb *ptr) {
+    timerwheel[TIMER_SLOT(ptr->wake_tick)].dequeue(ptr);
+    ptr->sleeping = FALSE;
+}
+
+/* Wake the sleepers in one slot that are due by 'now'. Sleepers further
+ * than a full revolution away share the slot and are left in place */
+static void timer_expire(unsigned int slot, unsigned int now) {
+    pcb *ptr = timerwheel[slot].get_front();
+    pcb *last;
+    if (ptr == NULL)
+        return;
+    last = ptr->tprev;
+    while (TRUE) {
+        pcb *next = ptr->tnext;
+        bool done = (ptr == last);
+        if ((int)(now - ptr->wake_tick) >= 0) {
+            timer_remove(ptr);
+            if (ptr->wait_state == WAIT_RECEIVE)    // receive timed out
+                KReceiveExpire(ptr);
+            ready_wake(ptr);
+        }
+        if (done)
+            break;
+        ptr = next;
+    }
+}
+
+/* Process every slot from the last processed tick up to 'ticks'. Normally one
+ * slot; after a tickless sleep one per tick slept (at most one revolution) */
+void timer_advance(void) {
+    unsigned int now = ticks;
+    unsigned int behind = now - wheel_tick;
+    if (behind >= TIMER_WHEEL_SLOTS) {      // a full revolution or more: every slot is due
+        for (unsigned int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+            timer_expire(slot, now);
+    } else {
+        while (wheel_tick != now) {
+            wheel_tick++;
+            timer_expire(TIMER_SLOT(wheel_tick), now);
+        }
+    }
+    wheel_tick = now;
+}
+
+/* Ticks until the earliest sleeper is due, looking no further than 'horizon' ticks */
+unsigned long timer_next(unsigned long horizon) {
+    for (unsigned long t = 1; t <= horizon && t < TIMER_WHEEL_SLOTS; t++) {
+        unsigned int when = ticks + t;
+        pcb *ptr = timerwheel[TIMER_SLOT(when)].get_front();
+        pcb *first = ptr;
+        while (ptr != NULL) {
+            if (ptr->wake_tick == when)
+                return t;
+            ptr = ptr->tnext;
+            if (ptr == first)
+                break;
+        }
+    }
+    return horizon;
+}
@@ -0,0 +1,22 @@
+/*
+ * File: timer.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Kernel timer wheel. Sleeping processes are hashed by wake tick into
+ *          one of TIMER_WHEEL_SLOTS timer queues; each tick only the slot for
+ *          the current tick is examined, so the cost per tick is the number of
+ *          sleepers sharing that slot rather than the number of sleepers.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "queues.h"                     // pcb and t_queue object types
+
+#define TIMER_WHEEL_SLOTS   64                          // number of slots (power of two)
+#define TIMER_SLOT(t)       ((t) & (TIMER_WHEEL_SLOTS - 1)) // slot a wake tick hashes to
+
+void timer_insert(pcb *ptr, unsigned int wake_tick);    // place PCB on the wheel to be woken at wake_tick
+void timer_remove(pcb *ptr);                            // take PCB off the wheel before it expires
+void timer_advance(void);                               // wake every sleeper due up to the current 'ticks'
+unsigned long timer_next(unsigned long horizon);        // ticks until the next sleeper is due (max horizon)
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+File: tracedecode.py
+Purpose: Host side decoder for the binary kernel trace (see trace.h).
+         Reads a capture of the UART0 byte stream, picks out trace records
+         by their sync word and prints the kernel timeline with times
+         relative to the first record. Bytes that are not part of a record
+         (console text) are skipped.
+
+Usage:   tracedecode.py <capture file> [--mhz 16]
+"""
+
+import struct
+import sys
+
+TRACE_SYNC = 0xA55A
+RECORD = struct.Struct("<HBBLL")        # sync, event, pid, stamp, arg (tracerecord)
+
+EVENTS = ["REGISTER", "SWITCH", "BIND", "SEND", "RECEIVE", "BLOCK", "WAKE", "SLEEP", "TERMINATE", "THROTTLE", "INHERIT"]
+
+
+def describe(event, arg):
+    """Readable argument for an event"""
+    if event == "REGISTER":
+        return "priority %d" % arg
+    if event == "SWITCH":
+        return "from P%d" % arg
+    if event == "BIND":
+        return "queue %d" % arg
+    if event == "BLOCK":
+        return "queue " + ",".join(str(q) for q in range(32) if arg & (1 << q))
+    if event in ("SEND", "RECEIVE"):
+        return "queue %d, %d bytes" % (arg >> 16, arg & 0xFFFF)
+    if event == "WAKE":
+        return "by P%d" % arg
+    if event == "SLEEP":
+        return "%d ticks" % arg
+    if event == "THROTTLE":
+        return "until tick %d" % arg
+    if event == "INHERIT":
+        return "priority %d" % arg
+    return ""
+
+
+def decode(data):
+    """Yield ('trace', record) and ('text', bytes) items from a byte stream"""
+    sync = struct.pack("<H", TRACE_SYNC)
+    pos = 0
+    while pos < len(data):
+        found = data.find(sync, pos)
+        if found < 0 or found + RECORD.size > len(data):
+            yield "text", data[pos:]
+            return
+        if found > pos:
+            yield "text", data[pos:found]
+        _, event, pid, stamp, arg = RECORD.unpack_from(data, found)
+        if event >= len(EVENTS):        # sync word inside text: not a record
+            yield "text", data[found:found + 1]
+            pos = found + 1
+            continue
+        yield "trace", (EVENTS[event], pid, stamp, arg)
+        pos = found + RECORD.size
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.exit(__doc__)
+    mhz = 16.0
+    if "--mhz" in argv:
+        mhz = float(argv[argv.index("--mhz") + 1])
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    start = None
+    last = None
+    elapsed = 0                         # cycles since the first record (unwrapped)
+    for kind, item in decode(data):
+        if kind == "text":
+            continue
+        event, pid, stamp, arg = item
+        if start is None:
+            start = last = stamp
+        elapsed += (stamp - last) & 0xFFFFFFFF
+        last = stamp
+        print("%12d cyc %10.1f us  P%-2d %-9s %s" % (elapsed, elapsed / mhz, pid, event, describe(event, arg)))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,29 @@
+/*
+ * File: trace.cpp
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: See trace.h. The kernel is the only writer of trace_head and
+ *          trace_drain() the only writer of trace_tail, so the ring needs no
+ *          lock between them.
+ */
+
+#include "trace.h"
+#include "uart.h"
+
+tracerecord tracering[TRACE_SIZE];
+volatile unsigned int trace_head = 0;
+volatile unsigned int trace_tail = 0;
+tracestats trace_stats;
+
+/* Send recorded events over UART0, stopping once the TX buffer cannot take a
+ * whole record. Interrupts are held off while a record is queued so console
+ * text printed by another process can not land in the middle of it */
+void trace_drain(void) {
+    while (trace_tail != trace_head && UART0_TX_BUFFER.space() >= (int) sizeof(tracerecord)) {
+        GIntDisable();
+        UART0_write((const char *) &tracering[trace_tail & (TRACE_SIZE - 1)], sizeof(tracerecord));
+        GIntEnable();
+        trace_tail = trace_tail + 1;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * File: trace.h
+ * Author: Stephen Sampson
+ * Original Date: October 2nd 2017
+ * Revised Date: December 5th 2017
+ * Purpose: Binary kernel event trace. Kernel paths record fixed size events
+ *          (event id, pid, DWT cycle stamp, argument) into a ring with a few
+ *          stores instead of formatting strings for the console. The ring is
+ *          drained over UART0 by the idle process (or on demand with
+ *          trace_drain()) and decoded on the host by tools/tracedecode.py.
+ *          With TRACE_ENABLE the console diagnostics (FormatTable) are not
+ *          printed from kernel paths; KPRINT() compiles them out.
+ */
+
+#pragma once                            // ensure file is included only once in compilation
+
+#include "globals.h"
+#include "kernel.h"                     // CYCLES()
+
+#define TRACE_ENABLE    TRUE            // record kernel events in place of console diagnostics
+#define TRACE_SIZE      256             // records in the ring (power of two)
+#define TRACE_SYNC      0xA55A          // marks the start of a record on the wire
+
+/* Kernel events recorded in the trace */
+enum traceevents {TR_REGISTER, TR_SWITCH, TR_BIND, TR_SEND, TR_RECEIVE, TR_BLOCK, TR_WAKE, TR_SLEEP, TR_TERMINATE, TR_THROTTLE, TR_INHERIT};
+
+/* One trace record, sent over UART0 as is (12 bytes, little endian) */
+struct tracerecord {
+    unsigned short sync;                // TRACE_SYNC
+    unsigned char event;                // event id (traceevents)
+    unsigned char pid;                  // process the event applies to
+    unsigned int stamp;                 // DWT cycle count when recorded
+    unsigned int arg;                   // event specific argument
+};
+
+/* Trace ring usage */
+struct tracestats {
+    unsigned long recorded;             // records written to the ring
+    unsigned long dropped;              // records lost because the ring was full
+};
+
+extern tracerecord tracering[];         // the ring (defined in trace.cpp)
+extern volatile unsigned int trace_head;// next record to write (only written by the kernel)
+extern volatile unsigned int trace_tail;// next record to drain (only written by trace_drain())
+extern tracestats trace_stats;          // trace ring usage (defined in trace.cpp)
+
+#if TRACE_ENABLE
+#define KPRINT(pid, s)  ((void) 0)      // console diagnostics replaced by the trace
+#else                                   // console diagnostics (only processes with a console row print)
+#define KPRINT(pid, s)  ((pid) < CONSOLE_ROWS ? UART0_printf(s) : (void) 0)
+#endif
+
+/* Record an event. Called from kernel paths: SVC and SysTick share a priority
+ * so they never interrupt each other, and PendSV records with interrupts
+ * disabled. A full ring drops the record */
+static inline void trace(unsigned event, unsigned long pid, unsigned long arg) {
+#if TRACE_ENABLE
+    unsigned int head = trace_head;
+    tracerecord *rec;
+    if (head - trace_tail >= TRACE_SIZE) {
+        trace_stats.dropped++;
+        return;
+    }
+    rec = &tracering[head & (TRACE_SIZE - 1)];
+    rec->sync = TRACE_SYNC;
+    rec->event = event;
+    rec->pid = pid;
+    rec->stamp = CYCLES();
+    rec->arg = arg;
+    trace_head = head + 1;
+    trace_stats.recorded++;
+#endif
+}
+
+void trace_drain(void);                 // send recorded events over UART0 while the TX buffer has room
@@ -1,75 +1,89 @@
-/*
- * File: uart.h
- * Original Source: http://lh.ece.dal.ca/eced4402/Tiva_UART_EchoV1.c
- * Original Author: Emad Khan
- * Modified By: Stephen Sampson
- * Revised Date: December 5th 2017
- * Purpose: UART Defines and Prototypes
- */
-
-#pragma once                                // ensure file is included only once in compilation
-
-#include <string>
-
-// UART0 & PORTA Registers
-#define GPIO_PORTA_AFSEL_R  (*((volatile unsigned long *)0x40058420))   // GPIOA Alternate Function Select Register
-#define GPIO_PORTA_DEN_R    (*((volatile unsigned long *)0x4005851C))   // GPIOA Digital Enable Register
-#define GPIO_PORTA_PCTL_R   (*((volatile unsigned long *)0x4005852C))   // GPIOA Port Control Register
-#define UART0_DR_R          (*((volatile unsigned long *)0x4000C000))   // UART0 Data Register
-#define UART0_FR_R          (*((volatile unsigned long *)0x4000C018))   // UART0 Flag Register
-#define UART0_IBRD_R        (*((volatile unsigned long *)0x4000C024))   // UART0 Integer Baud-Rate Divisor Register
-#define UART0_FBRD_R        (*((volatile unsigned long *)0x4000C028))   // UART0 Fractional Baud-Rate Divisor Register
-#define UART0_LCRH_R        (*((volatile unsigned long *)0x4000C02C))   // UART0 Line Control Register
-#define UART0_CTL_R         (*((volatile unsigned long *)0x4000C030))   // UART0 Control Register
-#define UART0_IFLS_R        (*((volatile unsigned long *)0x4000C034))   // UART0 Interrupt FIFO Level Select Register
-#define UART0_IM_R          (*((volatile unsigned long *)0x4000C038))   // UART0 Interrupt Mask Register
-#define UART0_MIS_R         (*((volatile unsigned long *)0x4000C040))   // UART0 Masked Interrupt Status Register
-#define UART0_ICR_R         (*((volatile unsigned long *)0x4000C044))   // UART0 Interrupt Clear Register
-#define UART0_CC_R          (*((volatile unsigned long *)0x4000CFC8))   // UART0 Clock Control Register
-
-#define INT_VEC_UART0           5           // UART0 RX and TX interrupt index (decimal)
-#define UART_FR_TXFF            0x00000020  // UART Transmit FIFO Full
-#define UART_FR_RXFE            0x00000010  // UART Receive FIFO Empty
-#define UART_RX_FIFO_ONE_EIGHT  0x00000038  // UART Receive FIFO Interrupt Level at >= 1/8
-#define UART_TX_FIFO_SVN_EIGHT  0x00000007  // UART Transmit FIFO Interrupt Level at <= 7/8
-#define UART_LCRH_WLEN_8        0x00000060  // 8 bit word length
-#define UART_LCRH_FEN           0x00000010  // UART Enable FIFOs
-#define UART_CTL_UARTEN         0x00000301  // UART RX/TX Enable
-#define UART_INT_TX             0x020       // Transmit Interrupt Mask
-#define UART_INT_RX             0x010       // Receive Interrupt Mask
-#define UART_INT_RT             0x040       // Receive Timeout Interrupt Mask
-#define UART_CTL_EOT            0x00000010  // UART End of Transmission Enable
-#define EN_RX_PA0               0x00000001  // Enable Receive Function on PA0
-#define EN_TX_PA1               0x00000002  // Enable Transmit Function on PA1
-#define EN_DIG_PA0              0x00000001  // Enable Digital I/O on PA0
-#define EN_DIG_PA1              0x00000002  // Enable Digital I/O on PA1
-
-// Clock Gating Registers
-#define SYSCTL_RCGCGPIO_R      (*((volatile unsigned long *)0x400FE608))
-#define SYSCTL_RCGCUART_R      (*((volatile unsigned long *)0x400FE618))
-
-#define SYSCTL_RCGCGPIO_UART0   0x00000001  // UART0 Clock Gating Control
-#define SYSCTL_RCGCUART_GPIOA   0x00000001  // Port A Clock Gating Control
-
-// Clock Configuration Register
-#define SYSCTRL_RCC_R           (*((volatile unsigned long *)0x400FE0B0))
-
-#define CLEAR_USRSYSDIV         0xF83FFFFF  // Clear USRSYSDIV Bits
-#define SET_BYPASS              0x00000800  // Set BYPASS Bit
-
-#define NVIC_EN0_R      (*((volatile unsigned long *)0xE000E100))       // Interrupt 0-31 Set Enable Register
-#define NVIC_EN1_R      (*((volatile unsigned long *)0xE000E104))       // Interrupt 32-54 Set Enable Register
-
-
-
-
-/* Globals */
-volatile char Data;                         // Input data from UART receive
-volatile int GotData;                       // T|F - Data available from UART
-
-/* Prototypes */
-void UART0_Init(void);                                                  // Initialize UART0
-void InterruptEnable(unsigned long InterruptIndex);                     // Enable interrupt in EN0 and EN1 registers
-void UART0_IntEnable(unsigned long flags);                              // Set specified bits for interrupt
-extern "C" void UART0_IntHandler(void);                                 // The UART interrupt handler
-void UART0_printf(std::string toprint);                                 // Allow printing of strings to UART
+/*
+ * File: uart.h
+ * Original Source: http://lh.ece.dal.ca/eced4402/Tiva_UART_EchoV1.c
+ * Original Author: Emad Khan
+ * Modified By: Stephen Sampson
+ * Revised Date: December 5th 2017
+ * Purpose: UART Defines and Prototypes
+ */
+
+#pragma once                                // ensure file is included only once in compilation
+
+#include "port.h"                           // HWREG() (memory mapped registers)
+
+#include <string>
+
+// UART0 & PORTA Registers
+#define GPIO_PORTA_AFSEL_R  HWREG(0x40058420)   // GPIOA Alternate Function Select Register
+#define GPIO_PORTA_DEN_R    HWREG(0x4005851C)   // GPIOA Digital Enable Register
+#define GPIO_PORTA_PCTL_R   HWREG(0x4005852C)   // GPIOA Port Control Register
+#define UART0_DR_R          HWREG(0x4000C000)   // UART0 Data Register
+#define UART0_FR_R          HWREG(0x4000C018)   // UART0 Flag Register
+#define UART0_IBRD_R        HWREG(0x4000C024)   // UART0 Integer Baud-Rate Divisor Register
+#define UART0_FBRD_R        HWREG(0x4000C028)   // UART0 Fractional Baud-Rate Divisor Register
+#define UART0_LCRH_R        HWREG(0x4000C02C)   // UART0 Line Control Register
+#define UART0_CTL_R         HWREG(0x4000C030)   // UART0 Control Register
+#define UART0_IFLS_R        HWREG(0x4000C034)   // UART0 Interrupt FIFO Level Select Register
+#define UART0_IM_R          HWREG(0x4000C038)   // UART0 Interrupt Mask Register
+#define UART0_MIS_R         HWREG(0x4000C040)   // UART0 Masked Interrupt Status Register
+#define UART0_ICR_R         HWREG(0x4000C044)   // UART0 Interrupt Clear Register
+#define UART0_CC_R          HWREG(0x4000CFC8)   // UART0 Clock Control Register
+
+#define INT_VEC_UART0           5           // UART0 RX and TX interrupt index (decimal)
+#define UART_FR_TXFF            0x00000020  // UART Transmit FIFO Full
+#define UART_FR_RXFE            0x00000010  // UART Receive FIFO Empty
+#define UART_RX_FIFO_ONE_EIGHT  0x00000038  // UART Receive FIFO Interrupt Level at >= 1/8
+#define UART_TX_FIFO_SVN_EIGHT  0x00000007  // UART Transmit FIFO Interrupt Level at <= 7/8
+#define UART_IFLS_RX1_8         0x00000000  // UART Receive Interrupt when RX FIFO >= 1/8 full
+#define UART_IFLS_TX1_8         0x00000000  // UART Transmit Interrupt when TX FIFO drops to <= 1/8 full (2 of 16 bytes)
+#define UART_LCRH_WLEN_8        0x00000060  // 8 bit word length
+#define UART_LCRH_FEN           0x00000010  // UART Enable FIFOs
+#define UART_CTL_UARTEN         0x00000301  // UART RX/TX Enable
+#define UART_INT_TX             0x020       // Transmit Interrupt Mask
+#define UART_INT_RX             0x010       // Receive Interrupt Mask
+#define UART_INT_RT             0x040       // Receive Timeout Interrupt Mask
+#define UART_CTL_EOT            0x00000010  // UART End of Transmission Enable
+#define EN_RX_PA0               0x00000001  // Enable Receive Function on PA0
+#define EN_TX_PA1               0x00000002  // Enable Transmit Function on PA1
+#define EN_DIG_PA0              0x00000001  // Enable Digital I/O on PA0
+#define EN_DIG_PA1              0x00000002  // Enable Digital I/O on PA1
+
+// Clock Gating Registers
+#define SYSCTL_RCGCGPIO_R      HWREG(0x400FE608)
+#define SYSCTL_RCGCUART_R      HWREG(0x400FE618)
+
+#define SYSCTL_RCGCGPIO_UART0   0x00000001  // UART0 Clock Gating Control
+#define SYSCTL_RCGCUART_GPIOA   0x00000001  // Port A Clock Gating Control
+
+// Clock Configuration Register
+#define SYSCTRL_RCC_R           HWREG(0x400FE0B0)
+
+#define CLEAR_USRSYSDIV         0xF83FFFFF  // Clear USRSYSDIV Bits
+#define SET_BYPASS              0x00000800  // Set BYPASS Bit
+
+#define NVIC_EN0_R      HWREG(0xE000E100)       // Interrupt 0-31 Set Enable Register
+#define NVIC_EN1_R      HWREG(0xE000E104)       // Interrupt 32-54 Set Enable Register
+
+
+
+
+/* Globals */
+extern volatile char Data;                  // Input data from UART receive (defined in uart.cpp)
+extern volatile int GotData;                // T|F - Data available from UART (defined in uart.cpp)
+
+/* TX counters (bytes per interrupt shows how well the FIFO batches transmission) */
+struct uarttxstats {
+    unsigned long interrupts;               // TX interrupts taken
+    unsigned long bytes;                    // bytes written to the TX FIFO (by the ISR or UART0_printf)
+};
+
+extern uarttxstats uart_tx_stats;           // UART0 TX counters (defined in uart.cpp)
+
+/* Prototypes */
+void UART0_Init(void);                                                  // Initialize UART0
+void InterruptEnable(unsigned long InterruptIndex);                     // Enable interrupt in EN0 and EN1 registers
+void UART0_IntEnable(unsigned long flags);                              // Set specified bits for interrupt
+extern "C" void UART0_IntHandler(void);                                 // The UART interrupt handler
+void UART0_printf(const std::string &toprint);                          // Allow printing of strings to UART
+void UART0_printnum(unsigned long num);                                 // Allow printing of unsigned numbers to UART
+void UART0_write(const char *data, unsigned len);                       // Queue raw bytes (binary safe) for UART